@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    BenchmarkUtils.h
+
+    Command line options, timing and parameter helpers shared by the benchmarks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+// Value following a "--name" option, or the fallback if it isn't given
+inline juce::String getOption(const juce::StringArray& args, const juce::String& name, const juce::String& fallback = {})
+{
+    auto index = args.indexOf(name);
+
+    if (index >= 0 && index + 1 < args.size())
+        return args[index + 1];
+
+    return fallback;
+}
+
+// Comma separated list of integers, e.g. "--instances 1,10,100"
+inline std::vector<int> getIntListOption(const juce::StringArray& args, const juce::String& name, const juce::String& fallback)
+{
+    std::vector<int> values;
+
+    for (auto& token : juce::StringArray::fromTokens(getOption(args, name, fallback), ",", {}))
+        if (token.getIntValue() > 0)
+            values.push_back(token.getIntValue());
+
+    return values;
+}
+
+// Look for a file next to the executable or in any folder above it (the benchmarks live inside the repo)
+inline juce::File findRepoFile(const juce::String& name)
+{
+    for (auto dir = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getParentDirectory();
+         dir.exists() && ! dir.isRoot();
+         dir = dir.getParentDirectory())
+    {
+        auto file = dir.getChildFile(name);
+
+        if (file.existsAsFile())
+            return file;
+    }
+
+    return juce::File::getCurrentWorkingDirectory().getChildFile(name);
+}
+
+// Seconds elapsed since a getHighResolutionTicks() reading
+inline double secondsSince(juce::int64 startTicks)
+{
+    return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+}
+
+// Distribution of a set of timings (in seconds)
+struct TimingStats
+{
+    double mean = 0, median = 0, p99 = 0, max = 0;
+
+    explicit TimingStats(std::vector<double> timings)
+    {
+        if (timings.empty())
+            return;
+
+        std::sort(timings.begin(), timings.end());
+
+        mean = std::accumulate(timings.begin(), timings.end(), 0.0) / (double) timings.size();
+        median = timings[timings.size() / 2];
+        p99 = timings[juce::jmin(timings.size() - 1, (size_t) ((double) timings.size() * 0.99))];
+        max = timings.back();
+    }
+};
+
+// Set a parameter in its real units (Hz, dB, Q or slope index)
+inline void setParameter(_3BandEqAudioProcessor& processor, const juce::String& parameterID, float value)
+{
+    if (auto* parameter = processor.apvts.getParameter(parameterID))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+// Every band engaged, cuts at the given slope: the most work one instance can do
+inline void setBusyParameters(_3BandEqAudioProcessor& processor, int slope)
+{
+    setParameter(processor, "LowCut Freq", 80.f);
+    setParameter(processor, "LowCut Slope", (float) slope);
+    setParameter(processor, "HighCut Freq", 12000.f);
+    setParameter(processor, "HighCut Slope", (float) slope);
+    setParameter(processor, "Peak Freq", 1000.f);
+    setParameter(processor, "Peak Gain", 3.f);
+    setParameter(processor, "Peak Quality", 1.f);
+}
+
+// Design a chain straight from parameter values, without a processor
+inline void designChain(MonoChain& chain, const ChainParameters& parameters, double sampleRate)
+{
+    prepareCoefficients(chain);
+    updateCoefficients(chain.get<ChainPositions::Peak>().coefficients, createPeakFilter(parameters, sampleRate));
+    updateCutFilter(chain.get<ChainPositions::LowCut>(), createLowCutFilter(parameters, sampleRate), parameters.lowCutSlope);
+    updateCutFilter(chain.get<ChainPositions::HighCut>(), createHighCutFilter(parameters, sampleRate), parameters.highCutSlope);
+}
+
+// The same settings setBusyParameters gives a processor
+inline void designBusyChain(MonoChain& chain, double sampleRate, int slope)
+{
+    ChainParameters parameters;
+    parameters.lowCutFreq = 80.f;
+    parameters.highCutFreq = 12000.f;
+    parameters.lowCutSlope = (Slope) slope;
+    parameters.highCutSlope = (Slope) slope;
+    parameters.peakFreq = 1000.f;
+    parameters.peakGain = 3.f;
+    parameters.peakQuality = 1.f;
+
+    designChain(chain, parameters, sampleRate);
+}
+
+// White noise at about -12 dBFS
+inline void fillWithNoise(juce::AudioBuffer<float>& buffer, juce::Random& random)
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        auto* samples = buffer.getWritePointer(channel);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            samples[i] = (random.nextFloat() * 2.f - 1.f) * 0.25f;
+    }
+}
@@ -0,0 +1,243 @@
+/*
+  ==============================================================================
+
+    GraphBenchmark.cpp
+
+    How many EQ instances fit in a real-time budget inside a host graph.
+
+  ==============================================================================
+*/
+
+#include "GraphBenchmark.h"
+#include "BenchmarkUtils.h"
+
+namespace
+{
+    using Node = juce::AudioProcessorGraph::Node;
+    using ChannelMap = std::vector<std::pair<int, int>>;
+
+    enum class Topology
+    {
+        serial,
+        parallel,
+        mixed
+    };
+
+    const char* getTopologyName(Topology topology)
+    {
+        switch (topology)
+        {
+            case Topology::serial:   return "serial";
+            case Topology::parallel: return "parallel";
+            case Topology::mixed:    return "mixed";
+        }
+
+        return "";
+    }
+
+    // How the EQ is wired in the template graph
+    struct GraphTemplate
+    {
+        int numChannels = 2;
+
+        // (upstream channel, EQ channel) and (EQ channel, downstream channel) pairs
+        ChannelMap inputs{ { 0, 0 }, { 1, 1 } };
+        ChannelMap outputs{ { 0, 0 }, { 1, 1 } };
+    };
+
+    // Read the EQ's channel count and connections out of an AudioPluginHost .filtergraph.
+    // The saved STATE is wrapped by the VST3 host, so instances start from their own defaults.
+    GraphTemplate loadTemplate(const juce::File& file)
+    {
+        GraphTemplate layout;
+        auto xml = juce::parseXML(file);
+
+        if (xml == nullptr)
+        {
+            std::cout << "Couldn't read " << file.getFullPathName() << ", using a plain stereo insert" << std::endl;
+            return layout;
+        }
+
+        int eqUid = -1;
+
+        for (auto* filter : xml->getChildWithTagNameIterator("FILTER"))
+        {
+            if (auto* plugin = filter->getChildByName("PLUGIN"))
+            {
+                if (plugin->getStringAttribute("name") == JucePlugin_Name)
+                {
+                    eqUid = filter->getIntAttribute("uid");
+                    layout.numChannels = juce::jmax(plugin->getIntAttribute("numInputs"), plugin->getIntAttribute("numOutputs"));
+                }
+            }
+        }
+
+        ChannelMap inputs, outputs;
+
+        for (auto* connection : xml->getChildWithTagNameIterator("CONNECTION"))
+        {
+            auto srcChannel = connection->getIntAttribute("srcChannel");
+            auto dstChannel = connection->getIntAttribute("dstChannel");
+
+            // Skip the MIDI channel (0x1000), the benchmark only feeds audio
+            if (srcChannel >= layout.numChannels || dstChannel >= layout.numChannels)
+                continue;
+
+            if (connection->getIntAttribute("dstFilter") == eqUid)
+                inputs.push_back({ srcChannel, dstChannel });
+            else if (connection->getIntAttribute("srcFilter") == eqUid)
+                outputs.push_back({ srcChannel, dstChannel });
+        }
+
+        if (eqUid < 0 || inputs.empty() || outputs.empty())
+        {
+            std::cout << "No wired " << JucePlugin_Name << " node in " << file.getFileName() << ", using a plain stereo insert" << std::endl;
+            return {};
+        }
+
+        layout.inputs = inputs;
+        layout.outputs = outputs;
+        return layout;
+    }
+
+    // Serial is one chain of N, parallel is N chains of one, mixed is about sqrt(N) chains of sqrt(N)
+    void buildGraph(juce::AudioProcessorGraph& graph, Topology topology, int numInstances, const GraphTemplate& layout, int slope)
+    {
+        using IO = juce::AudioProcessorGraph::AudioGraphIOProcessor;
+        constexpr auto noUpdate = juce::AudioProcessorGraph::UpdateKind::none;
+
+        graph.clear();
+
+        auto input = graph.addNode(std::make_unique<IO>(IO::audioInputNode), {}, noUpdate);
+        auto output = graph.addNode(std::make_unique<IO>(IO::audioOutputNode), {}, noUpdate);
+
+        auto connect = [&graph](const Node::Ptr& from, const Node::Ptr& to, const ChannelMap& channels)
+        {
+            for (auto& channel : channels)
+                graph.addConnection({ { from->nodeID, channel.first }, { to->nodeID, channel.second } }, noUpdate);
+        };
+
+        auto numChains = topology == Topology::serial   ? 1
+                       : topology == Topology::parallel ? numInstances
+                                                        : juce::jmax(1, juce::roundToInt(std::sqrt((double) numInstances)));
+
+        for (int chain = 0; chain < numChains; ++chain)
+        {
+            auto chainLength = numInstances / numChains + (chain < numInstances % numChains ? 1 : 0);
+            auto previous = input;
+
+            for (int i = 0; i < chainLength; ++i)
+            {
+                auto processor = std::make_unique<_3BandEqAudioProcessor>();
+                setBusyParameters(*processor, slope);
+
+                auto node = graph.addNode(std::move(processor), {}, noUpdate);
+                connect(previous, node, layout.inputs);
+                previous = node;
+            }
+
+            connect(previous, output, layout.outputs);
+        }
+
+        graph.rebuild();
+    }
+
+    // Time every callback after a short warm-up
+    TimingStats measure(juce::AudioProcessorGraph& graph, int numChannels, int blockSize, int numBlocks)
+    {
+        constexpr int warmUpBlocks = 50;
+
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(1);
+
+        std::vector<double> timings;
+        timings.reserve((size_t) numBlocks);
+
+        for (int i = -warmUpBlocks; i < numBlocks; ++i)
+        {
+            fillWithNoise(buffer, random);
+            midi.clear();
+
+            auto start = juce::Time::getHighResolutionTicks();
+            graph.processBlock(buffer, midi);
+
+            if (i >= 0)
+                timings.push_back(secondsSince(start));
+        }
+
+        return TimingStats(timings);
+    }
+}
+
+int runGraphBenchmark(const juce::StringArray& args)
+{
+    auto instanceCounts = getIntListOption(args, "--instances", "1,2,5,10,20,50,100,200,500,1000");
+    auto blockSize = getOption(args, "--block", "256").getIntValue();
+    auto sampleRate = getOption(args, "--rate", "48000").getDoubleValue();
+    auto numBlocks = getOption(args, "--blocks", "2000").getIntValue();
+    auto slope = juce::jlimit(0, 3, getOption(args, "--slope", "3").getIntValue());
+    auto templateFile = juce::File::getCurrentWorkingDirectory().getChildFile(
+        getOption(args, "--graph", findRepoFile("3-Band-Eq.filtergraph").getFullPathName()));
+
+    std::vector<Topology> topologies{ Topology::serial, Topology::parallel, Topology::mixed };
+
+    if (auto name = getOption(args, "--topology"); name.isNotEmpty())
+        topologies.erase(std::remove_if(topologies.begin(), topologies.end(),
+                                        [&name](Topology t) { return name != getTopologyName(t); }),
+                         topologies.end());
+
+    if (instanceCounts.empty() || topologies.empty() || blockSize <= 0 || sampleRate <= 0 || numBlocks <= 0)
+    {
+        std::cout << "Invalid options" << std::endl;
+        return 1;
+    }
+
+    auto layout = loadTemplate(templateFile);
+    auto budget = blockSize / sampleRate;
+
+    std::cout << "Template " << templateFile.getFileName() << ": " << layout.numChannels << " channels, "
+              << (int) layout.inputs.size() << " inputs / " << (int) layout.outputs.size() << " outputs per instance" << std::endl;
+    std::cout << "Block " << blockSize << " @ " << sampleRate << " Hz, budget " << budget * 1.0e6 << " us, "
+              << numBlocks << " blocks, slope " << (slope + 1) * 12 << " db/Oct" << std::endl << std::endl;
+
+    std::cout << juce::String::formatted("%-9s %6s %10s %10s %10s %10s %9s %14s %8s",
+                                         "topology", "N", "mean us", "median us", "p99 us", "max us",
+                                         "headroom", "ns/inst-samp", "vs min N") << std::endl;
+
+    for (auto topology : topologies)
+    {
+        double firstCostPerSample = 0;
+        int largestWithinBudget = 0;
+
+        for (auto numInstances : instanceCounts)
+        {
+            juce::AudioProcessorGraph graph;
+            graph.setPlayConfigDetails(layout.numChannels, layout.numChannels, sampleRate, blockSize);
+            buildGraph(graph, topology, numInstances, layout, slope);
+            graph.prepareToPlay(sampleRate, blockSize);
+
+            auto stats = measure(graph, layout.numChannels, blockSize, numBlocks);
+            graph.releaseResources();
+
+            // Per-instance cost per sample rises once the instances' state no longer fits in cache
+            auto costPerSample = stats.mean / ((double) numInstances * blockSize) * 1.0e9;
+
+            if (firstCostPerSample == 0)
+                firstCostPerSample = costPerSample;
+
+            if (stats.p99 < budget)
+                largestWithinBudget = numInstances;
+
+            std::cout << juce::String::formatted("%-9s %6d %10.1f %10.1f %10.1f %10.1f %8.1f%% %14.2f %7.2fx",
+                                                 getTopologyName(topology), numInstances,
+                                                 stats.mean * 1.0e6, stats.median * 1.0e6, stats.p99 * 1.0e6, stats.max * 1.0e6,
+                                                 (1.0 - stats.p99 / budget) * 100.0,
+                                                 costPerSample, costPerSample / firstCostPerSample) << std::endl;
+        }
+
+        std::cout << getTopologyName(topology) << ": largest N with p99 inside the budget = " << largestWithinBudget << std::endl << std::endl;
+    }
+
+    return 0;
+}
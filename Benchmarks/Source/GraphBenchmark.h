@@ -0,0 +1,20 @@
+/*
+  ==============================================================================
+
+    GraphBenchmark.h
+
+    How many EQ instances fit in a real-time budget inside a host graph.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Runs N instances in an AudioProcessorGraph (serial, parallel and mixed topologies)
+// wired like the EQ in 3-Band-Eq.filtergraph, and reports the callback time distribution.
+//
+//   graph [--instances 1,10,100] [--block 256] [--rate 48000] [--blocks 2000]
+//         [--slope 3] [--topology serial|parallel|mixed] [--graph path/to/template.filtergraph]
+int runGraphBenchmark(const juce::StringArray& args);
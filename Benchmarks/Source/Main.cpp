@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    This file contains the basic startup code for a JUCE application.
+
+    Headless benchmarks for the EQ. The first argument picks the benchmark,
+    the rest are its options.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "GraphBenchmark.h"
+#include "StartupBenchmark.h"
+#include "MonoBenchmark.h"
+#include "MatchBenchmark.h"
+#include "ReplayBenchmark.h"
+#include "OfflineBenchmark.h"
+#include "MeterBenchmark.h"
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "Usage: EqBenchmarks <benchmark> [options]" << std::endl << std::endl
+                  << "  graph    N instances in serial/parallel/mixed host graphs" << std::endl
+                  << "  startup  Constructing and preparing N instances" << std::endl
+                  << "  mono     Single-channel throughput, per-sample chain vs block engine" << std::endl
+                  << "  match    Analysing two files and fitting the bands to match them" << std::endl
+                  << "  replay   Re-running a recorded automation trace and timing every block" << std::endl
+                  << "  offline  Bounce rendering on the thread pool against the serial path" << std::endl
+                  << "  meter    Output meter overhead and loudness calibration" << std::endl;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The graph and the processors expect a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    auto benchmark = args[0];
+    args.remove(0);
+
+    if (benchmark == "graph")
+        return runGraphBenchmark(args);
+
+    if (benchmark == "startup")
+        return runStartupBenchmark(args);
+
+    if (benchmark == "mono")
+        return runMonoBenchmark(args);
+
+    if (benchmark == "match")
+        return runMatchBenchmark(args);
+
+    if (benchmark == "replay")
+        return runReplayBenchmark(args);
+
+    if (benchmark == "offline")
+        return runOfflineBenchmark(args);
+
+    if (benchmark == "meter")
+        return runMeterBenchmark(args);
+
+    printUsage();
+    return benchmark.isEmpty() ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+    MatchBenchmark.cpp
+
+    How long reference matching takes, and how close the fit gets.
+
+  ==============================================================================
+*/
+
+#include "MatchBenchmark.h"
+#include "BenchmarkUtils.h"
+#include "../../Source/ReferenceMatcher.h"
+
+namespace
+{
+    // A reference that needs every band: a steep low cut, a gentle high cut and a cut in the presence range
+    ChainParameters getTestSettings()
+    {
+        ChainParameters parameters;
+        parameters.lowCutFreq = 100.f;
+        parameters.lowCutSlope = Slope_24;
+        parameters.highCutFreq = 9000.f;
+        parameters.highCutSlope = Slope_12;
+        parameters.peakFreq = 2500.f;
+        parameters.peakGain = -4.f;
+        parameters.peakQuality = 1.5f;
+
+        return parameters;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> createWavWriter(const juce::File& file, double sampleRate)
+    {
+        file.deleteFile();
+
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+        juce::WavAudioFormat wav;
+
+        if (stream == nullptr)
+            return {};
+
+        // The writer owns the stream once it has been created
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, 2, 16, {}, 0));
+
+        if (writer != nullptr)
+            stream.release();
+
+        return writer;
+    }
+
+    // Stereo noise, and the same noise through the EQ at the given settings
+    bool writeTestFiles(const juce::File& sourceFile, const juce::File& referenceFile,
+                        const ChainParameters& parameters, double sampleRate, double seconds)
+    {
+        constexpr int blockSize = 32768;
+
+        auto sourceWriter = createWavWriter(sourceFile, sampleRate);
+        auto referenceWriter = createWavWriter(referenceFile, sampleRate);
+
+        if (sourceWriter == nullptr || referenceWriter == nullptr)
+            return false;
+
+        std::array<MonoChain, 2> chains;
+
+        for (auto& chain : chains)
+        {
+            designChain(chain, parameters, sampleRate);
+            chain.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+        }
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::Random random(1);
+
+        for (auto remaining = (juce::int64) (seconds * sampleRate); remaining > 0; remaining -= blockSize)
+        {
+            auto numSamples = (int) juce::jmin((juce::int64) blockSize, remaining);
+
+            fillWithNoise(buffer, random);
+            sourceWriter->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                juce::dsp::AudioBlock<float> block(buffer);
+                auto channelBlock = block.getSingleChannelBlock((size_t) channel).getSubBlock(0, (size_t) numSamples);
+                chains[(size_t) channel].process(juce::dsp::ProcessContextReplacing<float>(channelBlock));
+            }
+
+            referenceWriter->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+        }
+
+        return true;
+    }
+
+    juce::String describe(const ChainParameters& parameters)
+    {
+        auto slope = [](Slope s) { return juce::String(((int) s + 1) * 12) + " dB/Oct"; };
+
+        return juce::String::formatted("low cut %6.0f Hz %-9s high cut %6.0f Hz %-9s peak %6.0f Hz %+5.1f dB Q %.2f",
+                                       parameters.lowCutFreq, slope(parameters.lowCutSlope).toRawUTF8(),
+                                       parameters.highCutFreq, slope(parameters.highCutSlope).toRawUTF8(),
+                                       parameters.peakFreq, parameters.peakGain, parameters.peakQuality);
+    }
+
+    bool isSameFit(const ChainParameters& a, const ChainParameters& b)
+    {
+        return a.lowCutFreq == b.lowCutFreq && a.lowCutSlope == b.lowCutSlope
+            && a.highCutFreq == b.highCutFreq && a.highCutSlope == b.highCutSlope
+            && a.peakFreq == b.peakFreq && a.peakGain == b.peakGain && a.peakQuality == b.peakQuality;
+    }
+
+    // Analyse one file and report how long it took against its duration
+    LongTermSpectrum timeAnalysis(ReferenceMatcher& matcher, const juce::File& file, const char* label)
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        auto spectrum = matcher.analyse(file);
+        auto seconds = secondsSince(start);
+
+        auto duration = (double) spectrum.numFrames * (spectrum.fftSize / 2) / juce::jmax(1.0, spectrum.sampleRate);
+
+        std::cout << juce::String::formatted("%-10s %7.1f s of audio analysed in %6.3f s (%6.0fx real time)",
+                                             label, duration, seconds, duration / seconds) << std::endl;
+
+        return spectrum;
+    }
+}
+
+int runMatchBenchmark(const juce::StringArray& args)
+{
+    auto seconds = getOption(args, "--seconds", "300").getDoubleValue();
+    auto sampleRate = getOption(args, "--rate", "48000").getDoubleValue();
+    auto sourcePath = getOption(args, "--source");
+    auto referencePath = getOption(args, "--reference");
+
+    if (seconds <= 0 || sampleRate <= 0 || sourcePath.isEmpty() != referencePath.isEmpty())
+    {
+        std::cout << "Invalid options" << std::endl;
+        return 1;
+    }
+
+    // Generated files are removed again when these go out of scope
+    juce::TemporaryFile temporarySource(".wav"), temporaryReference(".wav");
+    auto useOwnFiles = sourcePath.isNotEmpty();
+    auto settings = getTestSettings();
+
+    auto sourceFile = useOwnFiles ? juce::File::getCurrentWorkingDirectory().getChildFile(sourcePath) : temporarySource.getFile();
+    auto referenceFile = useOwnFiles ? juce::File::getCurrentWorkingDirectory().getChildFile(referencePath) : temporaryReference.getFile();
+
+    if (! useOwnFiles)
+    {
+        std::cout << "Writing " << seconds << " s of stereo noise @ " << sampleRate << " Hz and an EQ'd copy..." << std::endl;
+
+        if (! writeTestFiles(sourceFile, referenceFile, settings, sampleRate, seconds))
+        {
+            std::cout << "Couldn't write the test files" << std::endl;
+            return 1;
+        }
+    }
+
+    ReferenceMatcher matcher;
+
+    auto totalStart = juce::Time::getHighResolutionTicks();
+    auto source = timeAnalysis(matcher, sourceFile, "source");
+    auto reference = timeAnalysis(matcher, referenceFile, "reference");
+
+    if (source.numFrames == 0 || reference.numFrames == 0)
+    {
+        std::cout << "Couldn't read the files" << std::endl;
+        return 1;
+    }
+
+    float rmsErrorDb = 0;
+    auto fitStart = juce::Time::getHighResolutionTicks();
+    auto fitted = ReferenceMatcher::fit(source, reference, false, &rmsErrorDb);
+    auto fitSeconds = secondsSince(fitStart);
+
+    auto totalSeconds = secondsSince(totalStart);
+
+    // Again on the scalar response loop that builds without SIMD use, which must fit the same
+    float scalarErrorDb = 0;
+    auto scalarStart = juce::Time::getHighResolutionTicks();
+    auto scalarFitted = ReferenceMatcher::fit(source, reference, false, &scalarErrorDb, false);
+    auto scalarSeconds = secondsSince(scalarStart);
+    auto sameFit = isSameFit(fitted, scalarFitted) && scalarErrorDb == rmsErrorDb;
+
+    std::cout << juce::String::formatted("fit        %.1f ms, %.2f dB rms from the spectral difference", fitSeconds * 1.0e3, rmsErrorDb) << std::endl;
+    std::cout << juce::String::formatted("scalar fit %.1f ms, %s", scalarSeconds * 1.0e3, sameFit ? "same fit" : "FAILED: the fits differ") << std::endl;
+    std::cout << juce::String::formatted("total      %.3f s", totalSeconds) << std::endl << std::endl;
+
+    if (! useOwnFiles)
+        std::cout << "used    " << describe(settings) << std::endl;
+
+    std::cout << "fitted  " << describe(fitted) << std::endl;
+
+    if (! sameFit)
+        std::cout << "scalar  " << describe(scalarFitted) << std::endl;
+
+    return sameFit ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+/*
+  ==============================================================================
+
+    MatchBenchmark.h
+
+    How long reference matching takes, and how close the fit gets.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Writes a stereo noise file and a copy of it through the EQ at known settings, then times
+// analysing both and fitting the bands, and compares the fit with the settings used.
+// Pass --source and --reference to time your own files instead. The fit is repeated on the
+// scalar response loop that builds without SIMD use; returns 1 if the two fits differ.
+//
+//   match [--seconds 300] [--rate 48000] [--source track.wav --reference mix.wav]
+int runMatchBenchmark(const juce::StringArray& args);
@@ -0,0 +1,22 @@
+/*
+  ==============================================================================
+
+    MeterBenchmark.h
+
+    Cost of the output meter next to the filters, and its loudness calibration.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Runs stereo noise through the busy filter chains alone and through the chains followed by
+// the OutputMeter, as processBlock does, reporting ns/frame for each and the meter's cost as a
+// percentage of the filters' alone, at each block size and slope (3 to 9 sections). Then checks
+// the calibration BS.1770 gives: a 0 dBFS 997 Hz sine on one channel reads -3.01 LUFS
+// integrated and short-term. Returns 1 if the check fails.
+//
+//   meter [--block-sizes 64,256,1024,4096] [--rate 48000] [--seconds 10] [--slopes 0,1,2,3]
+int runMeterBenchmark(const juce::StringArray& args);
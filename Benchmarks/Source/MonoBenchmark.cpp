@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    MonoBenchmark.cpp
+
+    Single-channel throughput of the filter cascade.
+
+  ==============================================================================
+*/
+
+#include "MonoBenchmark.h"
+#include "BenchmarkUtils.h"
+#include "../../Source/StateSpaceCascade.h"
+
+#if JUCE_USE_SIMD
+
+namespace
+{
+    // The active biquads in processing order
+    std::vector<BiquadCoefficients> getActiveSections(MonoChain& chain)
+    {
+        std::vector<BiquadCoefficients> sections;
+
+        auto add = [&sections](Filter& filter)
+        {
+            auto* c = filter.coefficients->coefficients.getRawDataPointer();
+            sections.push_back({ c[0], c[1], c[2], c[3], c[4] });
+        };
+
+        auto addCut = [&add](CutFilter& cut)
+        {
+            if (! cut.isBypassed<0>()) add(cut.get<0>());
+            if (! cut.isBypassed<1>()) add(cut.get<1>());
+            if (! cut.isBypassed<2>()) add(cut.get<2>());
+            if (! cut.isBypassed<3>()) add(cut.get<3>());
+        };
+
+        addCut(chain.get<ChainPositions::LowCut>());
+        add(chain.get<ChainPositions::Peak>());
+        addCut(chain.get<ChainPositions::HighCut>());
+
+        return sections;
+    }
+
+    // Transposed direct form II in double, as the reference for both float paths
+    struct ReferenceCascade
+    {
+        explicit ReferenceCascade(std::vector<BiquadCoefficients> coefficients)
+            : sections(std::move(coefficients)), states(sections.size())
+        {
+        }
+
+        void process(double* samples, int numSamples)
+        {
+            for (size_t s = 0; s < sections.size(); ++s)
+            {
+                const auto& c = sections[s];
+                auto [s1, s2] = states[s];
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    auto u = samples[i];
+                    auto y = c.b0 * u + s1;
+                    s1 = c.b1 * u - c.a1 * y + s2;
+                    s2 = c.b2 * u - c.a2 * y;
+                    samples[i] = y;
+                }
+
+                states[s] = { s1, s2 };
+            }
+        }
+
+        std::vector<BiquadCoefficients> sections;
+        std::vector<std::pair<double, double>> states;
+    };
+
+    struct Result
+    {
+        double chainNsPerSample = 0, engineNsPerSample = 0;
+        double chainError = 0, engineError = 0, peak = 0;
+    };
+
+    Result measure(double sampleRate, int slope, int blockSize, int numSamples)
+    {
+        MonoChain chain;
+        designBusyChain(chain, sampleRate, slope);
+        chain.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+
+        StateSpaceCascade engine;
+        engine.setSections(chain);
+
+        ReferenceCascade reference(getActiveSections(chain));
+
+        juce::AudioBuffer<float> input(1, blockSize), chainOutput(1, blockSize), engineOutput(1, blockSize);
+        std::vector<double> referenceOutput((size_t) blockSize);
+        juce::Random random(1);
+
+        Result result;
+        double chainSeconds = 0, engineSeconds = 0;
+        auto numBlocks = juce::jmax(1, numSamples / blockSize);
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            fillWithNoise(input, random);
+            chainOutput.makeCopyOf(input, true);
+            engineOutput.makeCopyOf(input, true);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            juce::dsp::AudioBlock<float> block(chainOutput);
+            chain.process(juce::dsp::ProcessContextReplacing<float>(block));
+            chainSeconds += secondsSince(start);
+
+            start = juce::Time::getHighResolutionTicks();
+            engine.process(engineOutput.getWritePointer(0), blockSize);
+            engineSeconds += secondsSince(start);
+
+            std::copy(input.getReadPointer(0), input.getReadPointer(0) + blockSize, referenceOutput.begin());
+            reference.process(referenceOutput.data(), blockSize);
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                auto expected = referenceOutput[(size_t) i];
+                result.chainError = juce::jmax(result.chainError, std::abs(chainOutput.getSample(0, i) - expected));
+                result.engineError = juce::jmax(result.engineError, std::abs(engineOutput.getSample(0, i) - expected));
+                result.peak = juce::jmax(result.peak, std::abs(expected));
+            }
+        }
+
+        auto totalSamples = (double) numBlocks * blockSize;
+        result.chainNsPerSample = chainSeconds / totalSamples * 1.0e9;
+        result.engineNsPerSample = engineSeconds / totalSamples * 1.0e9;
+        return result;
+    }
+
+    double toDecibels(double error, double peak)
+    {
+        return juce::Decibels::gainToDecibels(error / juce::jmax(peak, 1.0e-9), -200.0);
+    }
+}
+
+#endif
+
+int runMonoBenchmark(const juce::StringArray& args)
+{
+   #if ! JUCE_USE_SIMD
+    // Without SIMD support the processor has no block engine to compare against
+    juce::ignoreUnused(args);
+    std::cout << "The mono engine needs juce_dsp's SIMD support (JUCE_USE_SIMD)" << std::endl;
+    return 1;
+   #else
+    auto blockSizes = getIntListOption(args, "--block-sizes", "64,256,1024,4096,16384,65536");
+    auto sampleRate = getOption(args, "--rate", "48000").getDoubleValue();
+    auto seconds = getOption(args, "--seconds", "10").getDoubleValue();
+    auto slope = juce::jlimit(0, 3, getOption(args, "--slope", "3").getIntValue());
+
+    if (blockSizes.empty() || sampleRate <= 0 || seconds <= 0)
+    {
+        std::cout << "Invalid options" << std::endl;
+        return 1;
+    }
+
+    auto numSamples = (int) (seconds * sampleRate);
+
+    std::cout << "One channel @ " << sampleRate << " Hz, " << seconds << " s of noise per block size, slope "
+              << (slope + 1) * 12 << " db/Oct" << std::endl;
+    std::cout << "Errors are the largest deviation from a double-precision cascade, relative to its peak" << std::endl << std::endl;
+
+    std::cout << juce::String::formatted("%8s %12s %12s %8s %12s %12s",
+                                         "block", "chain ns/s", "engine ns/s", "speedup", "chain dB", "engine dB") << std::endl;
+
+    for (auto blockSize : blockSizes)
+    {
+        auto result = measure(sampleRate, slope, blockSize, numSamples);
+
+        std::cout << juce::String::formatted("%8d %12.2f %12.2f %7.2fx %12.1f %12.1f",
+                                             blockSize, result.chainNsPerSample, result.engineNsPerSample,
+                                             result.chainNsPerSample / result.engineNsPerSample,
+                                             toDecibels(result.chainError, result.peak),
+                                             toDecibels(result.engineError, result.peak)) << std::endl;
+    }
+
+    return 0;
+   #endif
+}
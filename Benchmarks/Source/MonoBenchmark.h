@@ -0,0 +1,20 @@
+/*
+  ==============================================================================
+
+    MonoBenchmark.h
+
+    Single-channel throughput of the filter cascade.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Runs one channel of noise through a MonoChain and through the StateSpaceCascade used on
+// mono buses, reporting ns/sample for each block size and how far either output strays from
+// a double-precision run of the same biquads.
+//
+//   mono [--block-sizes 64,256,1024,65536] [--rate 48000] [--seconds 10] [--slope 3]
+int runMonoBenchmark(const juce::StringArray& args);
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    OfflineBenchmark.cpp
+
+    Offline (bounce) rendering on the shared thread pool against the serial path.
+
+  ==============================================================================
+*/
+
+#include "OfflineBenchmark.h"
+#include "BenchmarkUtils.h"
+
+namespace
+{
+    // 20 Hz, Q 10, +24 dB: a pole time constant of about 0.6 s
+    void setResonantParameters(_3BandEqAudioProcessor& processor)
+    {
+        setParameter(processor, "LowCut Freq", 20.f);
+        setParameter(processor, "HighCut Freq", 20000.f);
+        setParameter(processor, "Peak Freq", 20.f);
+        setParameter(processor, "Peak Gain", 24.f);
+        setParameter(processor, "Peak Quality", 10.f);
+    }
+
+    struct Result
+    {
+        double serialSeconds = 0, offlineSeconds = 0;
+        double error = 0, peak = 0;
+    };
+
+    // Render the input in blocks, returning the time spent in processBlock
+    double render(_3BandEqAudioProcessor& processor, juce::AudioBuffer<float>& audio, int blockSize)
+    {
+        juce::MidiBuffer midi;
+        double seconds = 0;
+
+        for (int start = 0; start < audio.getNumSamples(); start += blockSize)
+        {
+            auto length = juce::jmin(blockSize, audio.getNumSamples() - start);
+            juce::AudioBuffer<float> view(audio.getArrayOfWritePointers(), audio.getNumChannels(), start, length);
+
+            auto ticks = juce::Time::getHighResolutionTicks();
+            processor.processBlock(view, midi);
+            seconds += secondsSince(ticks);
+        }
+
+        return seconds;
+    }
+
+    template<typename SetParameters>
+    Result measure(SetParameters&& setParameters, double sampleRate, int blockSize, const juce::AudioBuffer<float>& input)
+    {
+        auto create = [&](bool nonRealtime)
+        {
+            auto processor = std::make_unique<_3BandEqAudioProcessor>();
+            setParameters(*processor);
+            processor->setNonRealtime(nonRealtime);
+            processor->setPlayConfigDetails(2, 2, sampleRate, blockSize);
+            processor->prepareToPlay(sampleRate, blockSize);
+            return processor;
+        };
+
+        auto serial = create(false);
+        auto offline = create(true);
+
+        juce::AudioBuffer<float> serialOutput, offlineOutput;
+        serialOutput.makeCopyOf(input);
+        offlineOutput.makeCopyOf(input);
+
+        Result result;
+        result.serialSeconds = render(*serial, serialOutput, blockSize);
+        result.offlineSeconds = render(*offline, offlineOutput, blockSize);
+
+        for (int channel = 0; channel < input.getNumChannels(); ++channel)
+        {
+            for (int i = 0; i < input.getNumSamples(); ++i)
+            {
+                auto expected = (double) serialOutput.getSample(channel, i);
+                result.error = juce::jmax(result.error, std::abs(offlineOutput.getSample(channel, i) - expected));
+                result.peak = juce::jmax(result.peak, std::abs(expected));
+            }
+        }
+
+        return result;
+    }
+}
+
+int runOfflineBenchmark(const juce::StringArray& args)
+{
+    auto blockSizes = getIntListOption(args, "--block-sizes", "4096,65536,262144");
+    auto sampleRate = getOption(args, "--rate", "48000").getDoubleValue();
+    auto seconds = getOption(args, "--seconds", "30").getDoubleValue();
+
+    if (blockSizes.empty() || sampleRate <= 0 || seconds <= 0)
+    {
+        std::cout << "Invalid options" << std::endl;
+        return 1;
+    }
+
+    juce::AudioBuffer<float> input(2, (int) (seconds * sampleRate));
+    juce::Random random(1);
+    fillWithNoise(input, random);
+
+    std::cout << "Stereo @ " << sampleRate << " Hz, " << seconds << " s of noise, "
+              << juce::SystemStats::getNumCpus() << " cores" << std::endl;
+    std::cout << "Differences are the largest deviation of the offline render from the serial one, relative to its peak" << std::endl << std::endl;
+
+    std::cout << juce::String::formatted("%-10s %8s %12s %12s %8s %12s",
+                                         "settings", "block", "serial ms", "offline ms", "speedup", "diff dB") << std::endl;
+
+    auto report = [&](const char* name, auto&& setParameters)
+    {
+        for (auto blockSize : blockSizes)
+        {
+            auto result = measure(setParameters, sampleRate, blockSize, input);
+
+            std::cout << juce::String::formatted("%-10s %8d %12.2f %12.2f %7.2fx %12.1f",
+                                                 name, blockSize, result.serialSeconds * 1.0e3, result.offlineSeconds * 1.0e3,
+                                                 result.serialSeconds / result.offlineSeconds,
+                                                 juce::Decibels::gainToDecibels(result.error / juce::jmax(result.peak, 1.0e-9), -200.0))
+                      << std::endl;
+        }
+    };
+
+    report("busy", [](_3BandEqAudioProcessor& processor) { setBusyParameters(processor, 3); });
+    report("resonant", setResonantParameters);
+
+    return 0;
+}
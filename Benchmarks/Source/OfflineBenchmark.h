@@ -0,0 +1,22 @@
+/*
+  ==============================================================================
+
+    OfflineBenchmark.h
+
+    Offline (bounce) rendering on the shared thread pool against the serial path.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Renders the same stereo noise through a real-time instance (serial) and a non-realtime one
+// (channels and segments on the pool), at each block size. Reports the speed-up and the largest
+// difference between the two renders, for busy settings and for the most resonant peak the
+// parameters allow, whose warm-up is too long to segment. Segmented renders differ from the
+// serial one at the level of float rounding in the filter state, not of a cut-short warm-up.
+//
+//   offline [--block-sizes 4096,65536,262144] [--rate 48000] [--seconds 30]
+int runOfflineBenchmark(const juce::StringArray& args);
@@ -0,0 +1,254 @@
+/*
+  ==============================================================================
+
+    ReplayBenchmark.cpp
+
+    Re-running a recorded session's automation and block sizes offline.
+
+  ==============================================================================
+*/
+
+#include "ReplayBenchmark.h"
+#include "BenchmarkUtils.h"
+#include "../../Source/AutomationTrace.h"
+
+namespace
+{
+    using AutomationTrace::Event;
+
+    struct BlockInfo
+    {
+        int numSamples = 0;
+        double sampleRate = 0;
+        double traceSeconds = 0;
+
+        // Indices into the trace's parameter IDs of what changed before this block
+        std::vector<int> changedParameters;
+
+        double seconds = std::numeric_limits<double>::max();
+
+        double getLoad() const { return seconds / (numSamples / sampleRate); }
+    };
+
+    // Play the whole trace once, keeping each block's fastest time
+    void replay(const AutomationTrace::Trace& trace, std::vector<BlockInfo>& blocks, int maxBlockSize, int maxChannels)
+    {
+        auto processor = std::make_unique<_3BandEqAudioProcessor>();
+
+        // Replaying with EQ_AUTOMATION_TRACE still set mustn't record a trace of the replay
+        processor->disableAutomationRecording();
+
+        std::vector<juce::RangedAudioParameter*> parameters;
+        for (auto& parameterID : trace.parameterIDs)
+            parameters.push_back(processor->apvts.getParameter(parameterID));
+
+        juce::AudioBuffer<float> buffer(maxChannels, maxBlockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(1);
+
+        double sampleRate = 0;
+        int numChannels = 0;
+        size_t blockIndex = 0;
+
+        auto prepare = [&]
+        {
+            processor->releaseResources();
+            processor->setPlayConfigDetails(numChannels, numChannels, sampleRate, maxBlockSize);
+            processor->prepareToPlay(sampleRate, maxBlockSize);
+        };
+
+        for (auto& event : trace.events)
+        {
+            if (event.type == Event::sampleRate)
+            {
+                sampleRate = event.value;
+                numChannels = 0;    // re-prepare at the next block, once its channel count is known
+            }
+            else if (event.type == Event::parameter)
+            {
+                if (auto* parameter = parameters[event.parameterIndex])
+                    parameter->setValueNotifyingHost(parameter->convertTo0to1((float) event.value));
+            }
+            else if (event.type == Event::block)
+            {
+                auto nonRealtime = (event.flags & Event::nonRealtime) != 0;
+                auto channels = juce::jlimit(1, maxChannels, (int) event.numChannels);
+
+                if (channels != numChannels || nonRealtime != processor->isNonRealtime())
+                {
+                    numChannels = channels;
+                    processor->setNonRealtime(nonRealtime);
+                    prepare();
+                }
+
+                juce::AudioBuffer<float> view(buffer.getArrayOfWritePointers(), numChannels, event.numSamples);
+                fillWithNoise(view, random);
+
+                auto start = juce::Time::getHighResolutionTicks();
+                processor->processBlock(view, midi);
+                auto& block = blocks[blockIndex++];
+                block.seconds = juce::jmin(block.seconds, secondsSince(start));
+            }
+        }
+    }
+}
+
+int runReplayBenchmark(const juce::StringArray& args)
+{
+    auto traceFile = juce::File::getCurrentWorkingDirectory().getChildFile(getOption(args, "--trace"));
+    auto numRepeats = getOption(args, "--repeat", "3").getIntValue();
+    auto numSlowest = getOption(args, "--slowest", "10").getIntValue();
+    auto csvPath = getOption(args, "--csv");
+
+    AutomationTrace::Trace trace;
+
+    if (! traceFile.existsAsFile() || ! AutomationTrace::read(traceFile, trace))
+    {
+        std::cout << "Can't read a trace from " << traceFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if (numRepeats <= 0 || numSlowest < 0)
+    {
+        std::cout << "Invalid options" << std::endl;
+        return 1;
+    }
+
+    // One pass to size the buffers, note what each block followed and drop anything unusable
+    std::vector<BlockInfo> blocks;
+    std::vector<Event> events;
+    std::vector<int> changed;
+    double sampleRate = 0;
+    int maxBlockSize = 0, maxChannels = 1;
+
+    for (auto& event : trace.events)
+    {
+        if (event.type == Event::sampleRate && event.value > 0)
+        {
+            sampleRate = event.value;
+        }
+        else if (event.type == Event::parameter && event.parameterIndex < trace.parameterIDs.size())
+        {
+            changed.push_back(event.parameterIndex);
+        }
+        else if (event.type == Event::block && event.numSamples > 0 && sampleRate > 0)
+        {
+            BlockInfo block;
+            block.numSamples = event.numSamples;
+            block.sampleRate = sampleRate;
+            block.traceSeconds = (double) event.microseconds * 1.0e-6;
+            block.changedParameters = std::move(changed);
+            blocks.push_back(std::move(block));
+
+            changed.clear();
+            maxBlockSize = juce::jmax(maxBlockSize, (int) event.numSamples);
+            maxChannels = juce::jmax(maxChannels, (int) event.numChannels);
+        }
+        else
+        {
+            continue;
+        }
+
+        events.push_back(event);
+    }
+
+    if (blocks.empty())
+    {
+        std::cout << "The trace has no blocks" << std::endl;
+        return 1;
+    }
+
+    trace.events = std::move(events);
+
+    {
+        _3BandEqAudioProcessor processor;
+
+        for (auto& parameterID : trace.parameterIDs)
+            if (processor.apvts.getParameter(parameterID) == nullptr)
+                std::cout << "Warning: the trace's \"" << parameterID << "\" isn't a parameter of this build" << std::endl;
+    }
+
+    std::cout << traceFile.getFileName() << ": " << blocks.size() << " blocks, up to " << maxBlockSize
+              << " samples and " << maxChannels << " channels, "
+              << juce::String(blocks.back().traceSeconds, 1) << " s of session" << std::endl;
+
+    auto start = juce::Time::getHighResolutionTicks();
+
+    for (int repeat = 0; repeat < numRepeats; ++repeat)
+        replay(trace, blocks, maxBlockSize, maxChannels);
+
+    auto totalSeconds = secondsSince(start);
+
+    std::vector<double> timings, loads;
+    int overHalf = 0, overBudget = 0;
+
+    for (auto& block : blocks)
+    {
+        timings.push_back(block.seconds);
+        loads.push_back(block.getLoad());
+
+        overHalf += block.getLoad() > 0.5 ? 1 : 0;
+        overBudget += block.getLoad() > 1.0 ? 1 : 0;
+    }
+
+    TimingStats timing(timings), load(loads);
+
+    std::cout << numRepeats << " replays in " << juce::String(totalSeconds, 2) << " s" << std::endl << std::endl;
+    std::cout << juce::String::formatted("%-12s %10s %10s %10s %10s", "", "mean", "median", "p99", "max") << std::endl;
+    std::cout << juce::String::formatted("%-12s %10.2f %10.2f %10.2f %10.2f", "block us",
+                                         timing.mean * 1.0e6, timing.median * 1.0e6, timing.p99 * 1.0e6, timing.max * 1.0e6) << std::endl;
+    std::cout << juce::String::formatted("%-12s %10.3f %10.3f %10.3f %10.3f", "budget %",
+                                         load.mean * 100.0, load.median * 100.0, load.p99 * 100.0, load.max * 100.0) << std::endl;
+    std::cout << std::endl << overHalf << " blocks over half their budget, " << overBudget << " over all of it" << std::endl;
+
+    // The slowest blocks, relative to their budget
+    std::vector<size_t> order(blocks.size());
+    std::iota(order.begin(), order.end(), (size_t) 0);
+    std::sort(order.begin(), order.end(), [&blocks](size_t a, size_t b) { return blocks[a].getLoad() > blocks[b].getLoad(); });
+    order.resize(juce::jmin(order.size(), (size_t) numSlowest));
+
+    if (! order.empty())
+    {
+        std::cout << std::endl << juce::String::formatted("%8s %10s %8s %10s %10s  %s", "block", "at s", "samples", "us", "budget %", "changed") << std::endl;
+
+        for (auto index : order)
+        {
+            auto& block = blocks[index];
+
+            juce::StringArray changedIDs;
+            for (auto parameter : block.changedParameters)
+                changedIDs.addIfNotAlreadyThere(trace.parameterIDs[parameter]);
+
+            std::cout << juce::String::formatted("%8d %10.3f %8d %10.2f %10.3f  ",
+                                                 (int) index, block.traceSeconds, block.numSamples,
+                                                 block.seconds * 1.0e6, block.getLoad() * 100.0)
+                      << changedIDs.joinIntoString(", ") << std::endl;
+        }
+    }
+
+    // Every block, for plotting
+    if (csvPath.isNotEmpty())
+    {
+        auto csvFile = juce::File::getCurrentWorkingDirectory().getChildFile(csvPath);
+        csvFile.deleteFile();
+        juce::FileOutputStream csv(csvFile);
+
+        if (csv.failedToOpen())
+        {
+            std::cout << "Can't write " << csvFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        csv << "block,at_s,samples,sample_rate,us,budget_percent,changed\n";
+
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            auto& block = blocks[i];
+            csv << juce::String((int) i) << "," << juce::String(block.traceSeconds, 6) << "," << block.numSamples << ","
+                << juce::String(block.sampleRate) << "," << juce::String(block.seconds * 1.0e6, 3) << ","
+                << juce::String(block.getLoad() * 100.0, 4) << "," << (int) block.changedParameters.size() << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+/*
+  ==============================================================================
+
+    ReplayBenchmark.h
+
+    Re-running a recorded session's automation and block sizes offline.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Plays back a trace written with EQ_AUTOMATION_TRACE set: the same block sizes, sample rates
+// and parameter changes, in order, on noise. Reports the cost of every block against its
+// real-time budget and lists the slowest with the parameters that changed just before them.
+// Each block's cost is its fastest over the repeats.
+//
+//   replay --trace session.eqtrace [--repeat 3] [--slowest 10] [--csv blocks.csv]
+int runReplayBenchmark(const juce::StringArray& args);
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    StartupBenchmark.cpp
+
+    What opening a session with many EQ instances costs.
+
+  ==============================================================================
+*/
+
+#include "StartupBenchmark.h"
+#include "BenchmarkUtils.h"
+
+int runStartupBenchmark(const juce::StringArray& args)
+{
+    auto instanceCounts = getIntListOption(args, "--instances", "1,10,100,500");
+    auto blockSize = getOption(args, "--block", "512").getIntValue();
+    auto sampleRate = getOption(args, "--rate", "48000").getDoubleValue();
+
+    if (instanceCounts.empty() || blockSize <= 0 || sampleRate <= 0)
+    {
+        std::cout << "Invalid options" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Block " << blockSize << " @ " << sampleRate << " Hz (per-instance times in us)" << std::endl << std::endl;
+    std::cout << juce::String::formatted("%6s %12s %12s %12s %12s %12s",
+                                         "N", "construct", "prepare", "re-prepare", "destroy", "total ms") << std::endl;
+
+    for (auto numInstances : instanceCounts)
+    {
+        std::vector<std::unique_ptr<_3BandEqAudioProcessor>> instances;
+        instances.reserve((size_t) numInstances);
+
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numInstances; ++i)
+            instances.push_back(std::make_unique<_3BandEqAudioProcessor>());
+
+        auto constructSeconds = secondsSince(start);
+
+        // Hosts set the layout and rate before the first prepare
+        auto prepareAll = [&]
+        {
+            auto prepareStart = juce::Time::getHighResolutionTicks();
+
+            for (auto& instance : instances)
+            {
+                instance->setPlayConfigDetails(2, 2, sampleRate, blockSize);
+                instance->prepareToPlay(sampleRate, blockSize);
+            }
+
+            return secondsSince(prepareStart);
+        };
+
+        auto prepareSeconds = prepareAll();
+        auto reprepareSeconds = prepareAll();
+
+        start = juce::Time::getHighResolutionTicks();
+        instances.clear();
+        auto destroySeconds = secondsSince(start);
+
+        auto perInstance = [numInstances](double seconds) { return seconds / numInstances * 1.0e6; };
+
+        std::cout << juce::String::formatted("%6d %12.2f %12.2f %12.2f %12.2f %12.2f",
+                                             numInstances,
+                                             perInstance(constructSeconds), perInstance(prepareSeconds),
+                                             perInstance(reprepareSeconds), perInstance(destroySeconds),
+                                             (constructSeconds + prepareSeconds + reprepareSeconds + destroySeconds) * 1.0e3) << std::endl;
+    }
+
+    return 0;
+}
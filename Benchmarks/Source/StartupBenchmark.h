@@ -0,0 +1,19 @@
+/*
+  ==============================================================================
+
+    StartupBenchmark.h
+
+    What opening a session with many EQ instances costs.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Times constructing N instances, their first prepareToPlay, a repeat prepareToPlay
+// with unchanged settings (as hosts do while a session opens) and tearing them down.
+//
+//   startup [--instances 1,10,100,500] [--block 512] [--rate 48000]
+int runStartupBenchmark(const juce::StringArray& args);
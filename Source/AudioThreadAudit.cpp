@@ -0,0 +1,375 @@
+/*
+  ==============================================================================
+
+    AudioThreadAudit.cpp
+
+    Debug check that the audio thread never touches the heap or blocks on a lock.
+
+  ==============================================================================
+*/
+
+#include "AudioThreadAudit.h"
+
+#if EQ_AUDIO_THREAD_AUDIT_ENABLED
+
+#if JUCE_MSVC
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #include <crtdbg.h>
+#else
+ #include <dlfcn.h>
+ #include <pthread.h>
+
+ // glibc declares the C library functions noexcept, the definitions below must match
+ #ifndef __THROW
+  #define __THROW
+ #endif
+ #ifndef __THROWNL
+  #define __THROWNL __THROW
+ #endif
+#endif
+
+namespace
+{
+    thread_local bool isAuditing = false;
+    std::atomic<int> numHeapOperations{ 0 };
+    std::atomic<int> numLocks{ 0 };
+
+    void report(std::atomic<int>& count) noexcept
+    {
+        if (! isAuditing)
+            return;
+
+        // Stop auditing while reporting, the assertion handler may allocate itself
+        isAuditing = false;
+
+        // Something allocated, freed or waited for a lock on the audio thread
+        if (count++ == 0)
+            jassertfalse;
+
+        isAuditing = true;
+    }
+
+    void checkHeapOperation() noexcept   { report(numHeapOperations); }
+    void checkLock() noexcept            { report(numLocks); }
+
+   #if JUCE_MSVC
+    //==============================================================================
+    // Heap: the debug CRT's alloc hook sees malloc, calloc, realloc and free, and new and delete
+    // through them
+    _CRT_ALLOC_HOOK previousHook = nullptr;
+
+    int __cdecl allocHook(int allocType, void* userData, size_t size, int blockType,
+                          long requestNumber, const unsigned char* fileName, int lineNumber)
+    {
+        // The CRT's own bookkeeping blocks must not be touched
+        if (blockType != _CRT_BLOCK)
+            checkHeapOperation();
+
+        if (previousHook != nullptr)
+            return previousHook(allocType, userData, size, blockType, requestNumber, fileName, lineNumber);
+
+        return TRUE;
+    }
+
+    // Locks: this module's and the C++ runtime's imports of the blocking lock calls are pointed
+    // at checked versions. Try-locks are left alone, they are how audio code is meant to share state.
+    decltype(&EnterCriticalSection) enterCriticalSection = nullptr;
+    decltype(&AcquireSRWLockExclusive) acquireSRWLockExclusive = nullptr;
+    decltype(&AcquireSRWLockShared) acquireSRWLockShared = nullptr;
+
+    void WINAPI checkedEnterCriticalSection(LPCRITICAL_SECTION section)
+    {
+        checkLock();
+        enterCriticalSection(section);
+    }
+
+    void WINAPI checkedAcquireSRWLockExclusive(PSRWLOCK lock)
+    {
+        checkLock();
+        acquireSRWLockExclusive(lock);
+    }
+
+    void WINAPI checkedAcquireSRWLockShared(PSRWLOCK lock)
+    {
+        checkLock();
+        acquireSRWLockShared(lock);
+    }
+
+    // std::mutex locks inside the C++ runtime DLL, so its imports are patched as well as this
+    // module's. The checks only count on a thread inside ScopedAudioThread, so the patch leaves
+    // the host and other plugins sharing the DLL alone apart from a thread_local test.
+    std::array<HMODULE, 3> getModulesToPatch()
+    {
+        HMODULE module = nullptr;
+        GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                           reinterpret_cast<LPCWSTR>(&getModulesToPatch), &module);
+
+        // Neither is loaded if the CRT is linked statically: the runtime's locks are then part of this module
+        return { module, GetModuleHandleW(L"msvcp140d.dll"), GetModuleHandleW(L"msvcp140.dll") };
+    }
+
+    // Rewrite every entry in a module's import table that points at one function
+    void patchImports(HMODULE module, void* function, void* replacement)
+    {
+        auto* base = reinterpret_cast<BYTE*>(module);
+        auto* headers = reinterpret_cast<IMAGE_NT_HEADERS*>(base + reinterpret_cast<IMAGE_DOS_HEADER*>(base)->e_lfanew);
+        auto& directory = headers->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT];
+
+        if (directory.VirtualAddress == 0)
+            return;
+
+        for (auto* library = reinterpret_cast<IMAGE_IMPORT_DESCRIPTOR*>(base + directory.VirtualAddress); library->Name != 0; ++library)
+        {
+            for (auto* entry = reinterpret_cast<IMAGE_THUNK_DATA*>(base + library->FirstThunk); entry->u1.Function != 0; ++entry)
+            {
+                if (reinterpret_cast<void*>(entry->u1.Function) != function)
+                    continue;
+
+                DWORD protection = 0;
+                VirtualProtect(&entry->u1.Function, sizeof(entry->u1.Function), PAGE_READWRITE, &protection);
+                entry->u1.Function = reinterpret_cast<ULONG_PTR>(replacement);
+                VirtualProtect(&entry->u1.Function, sizeof(entry->u1.Function), protection, &protection);
+            }
+        }
+    }
+
+    void patchImports(void* function, void* replacement)
+    {
+        for (auto module : getModulesToPatch())
+            if (module != nullptr)
+                patchImports(module, function, replacement);
+    }
+
+    template<typename Function>
+    void hook(const char* name, Function& original, Function replacement)
+    {
+        // The loader binds imports to the final target of kernel32's forwarders, as GetProcAddress does
+        original = reinterpret_cast<Function>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), name));
+
+        if (original != nullptr)
+            patchImports(reinterpret_cast<void*>(original), reinterpret_cast<void*>(replacement));
+    }
+
+    template<typename Function>
+    void unhook(Function original, Function replacement)
+    {
+        if (original != nullptr)
+            patchImports(reinterpret_cast<void*>(replacement), reinterpret_cast<void*>(original));
+    }
+
+    // Install the hooks when the plugin is loaded
+    struct HookInstaller
+    {
+        HookInstaller()
+        {
+            previousHook = _CrtSetAllocHook(allocHook);
+
+            hook("EnterCriticalSection", enterCriticalSection, &checkedEnterCriticalSection);
+            hook("AcquireSRWLockExclusive", acquireSRWLockExclusive, &checkedAcquireSRWLockExclusive);
+            hook("AcquireSRWLockShared", acquireSRWLockShared, &checkedAcquireSRWLockShared);
+        }
+
+        ~HookInstaller()
+        {
+            unhook(enterCriticalSection, &checkedEnterCriticalSection);
+            unhook(acquireSRWLockExclusive, &checkedAcquireSRWLockExclusive);
+            unhook(acquireSRWLockShared, &checkedAcquireSRWLockShared);
+
+            _CrtSetAllocHook(previousHook);
+        }
+    };
+
+    HookInstaller hookInstaller;
+   #else
+    //==============================================================================
+    // The version of a function this module replaces that the rest of the process uses (looked up
+    // on first use, since other static initialisers may already allocate). The replacements are
+    // hidden, so the global lookup skips them and finds what an unaudited build would have bound
+    // to: a preloaded jemalloc or tcmalloc, say, rather than the C library behind it. Blocks the
+    // host allocates and the plugin frees, or the other way round, then stay with one allocator.
+    template<typename Function>
+    Function lookUpDefault(const char* name) noexcept
+    {
+        return reinterpret_cast<Function>(dlsym(RTLD_DEFAULT, name));
+    }
+
+    #define EQ_AUDIT_DEFAULT(function) static const auto real = lookUpDefault<decltype(&::function)>(#function)
+   #endif
+}
+
+#if ! JUCE_MSVC
+// Heap and lock entry points for this module only. They are hidden (see the end of the file), so they
+// bind every call made from the plugin's code, JUCE and any C code included, and leave the host and
+// other plugins alone.
+extern "C"
+{
+    void* malloc(size_t size) __THROW
+    {
+        EQ_AUDIT_DEFAULT(malloc);
+        checkHeapOperation();
+        return real(size);
+    }
+
+    void* calloc(size_t count, size_t size) __THROW
+    {
+        EQ_AUDIT_DEFAULT(calloc);
+        checkHeapOperation();
+        return real(count, size);
+    }
+
+    void* realloc(void* memory, size_t size) __THROW
+    {
+        EQ_AUDIT_DEFAULT(realloc);
+        checkHeapOperation();
+        return real(memory, size);
+    }
+
+    int posix_memalign(void** memory, size_t alignment, size_t size) __THROW
+    {
+        EQ_AUDIT_DEFAULT(posix_memalign);
+        checkHeapOperation();
+        return real(memory, alignment, size);
+    }
+
+    void free(void* memory) __THROW
+    {
+        EQ_AUDIT_DEFAULT(free);
+
+        if (memory != nullptr)
+            checkHeapOperation();
+
+        real(memory);
+    }
+
+    // Blocking acquisitions only: try-locks are how audio code is meant to share state
+    int pthread_mutex_lock(pthread_mutex_t* mutex) __THROWNL
+    {
+        EQ_AUDIT_DEFAULT(pthread_mutex_lock);
+        checkLock();
+        return real(mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* lock) __THROWNL
+    {
+        EQ_AUDIT_DEFAULT(pthread_rwlock_rdlock);
+        checkLock();
+        return real(lock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* lock) __THROWNL
+    {
+        EQ_AUDIT_DEFAULT(pthread_rwlock_wrlock);
+        checkLock();
+        return real(lock);
+    }
+}
+
+// Every form of new and delete, not just the plain ones: libstdc++'s array, nothrow and aligned
+// forms would call the host's operator new or the C library's allocator directly.
+namespace
+{
+    void* allocate(std::size_t size, std::size_t alignment) noexcept
+    {
+        void* memory = nullptr;
+        posix_memalign(&memory, juce::jmax(sizeof(void*), alignment), size != 0 ? size : 1);
+        return memory;
+    }
+
+    void* allocateOrThrow(std::size_t size, std::size_t alignment)
+    {
+        if (auto* memory = allocate(size, alignment))
+            return memory;
+
+        throw std::bad_alloc();
+    }
+
+    constexpr auto defaultAlignment = (std::size_t) __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+}
+
+void* operator new(std::size_t size)                                                        { return allocateOrThrow(size, defaultAlignment); }
+void* operator new[](std::size_t size)                                                      { return allocateOrThrow(size, defaultAlignment); }
+void* operator new(std::size_t size, std::align_val_t alignment)                            { return allocateOrThrow(size, (std::size_t) alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment)                          { return allocateOrThrow(size, (std::size_t) alignment); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept                        { return allocate(size, defaultAlignment); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept                      { return allocate(size, defaultAlignment); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept  { return allocate(size, (std::size_t) alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(size, (std::size_t) alignment); }
+
+void operator delete(void* memory) noexcept                                                 { std::free(memory); }
+void operator delete[](void* memory) noexcept                                               { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept                                    { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept                                  { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept                               { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept                             { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept                  { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept                { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept                          { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept                        { std::free(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept        { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept      { std::free(memory); }
+
+// Hidden, so every call from this module binds to the versions above while the host and other
+// plugins keep their own. (A visibility attribute would be ignored: the functions are already
+// declared by the system headers. Mach-O binds a module's calls to its own definitions anyway.)
+#if defined(__ELF__)
+static_assert(sizeof(std::size_t) == sizeof(unsigned long), "The mangled names below assume an LP64 size_t");
+
+__asm__(".hidden malloc\n"
+        ".hidden calloc\n"
+        ".hidden realloc\n"
+        ".hidden posix_memalign\n"
+        ".hidden free\n"
+        ".hidden pthread_mutex_lock\n"
+        ".hidden pthread_rwlock_rdlock\n"
+        ".hidden pthread_rwlock_wrlock\n"
+        ".hidden _Znwm\n"
+        ".hidden _Znam\n"
+        ".hidden _ZnwmSt11align_val_t\n"
+        ".hidden _ZnamSt11align_val_t\n"
+        ".hidden _ZnwmRKSt9nothrow_t\n"
+        ".hidden _ZnamRKSt9nothrow_t\n"
+        ".hidden _ZnwmSt11align_val_tRKSt9nothrow_t\n"
+        ".hidden _ZnamSt11align_val_tRKSt9nothrow_t\n"
+        ".hidden _ZdlPv\n"
+        ".hidden _ZdaPv\n"
+        ".hidden _ZdlPvm\n"
+        ".hidden _ZdaPvm\n"
+        ".hidden _ZdlPvSt11align_val_t\n"
+        ".hidden _ZdaPvSt11align_val_t\n"
+        ".hidden _ZdlPvmSt11align_val_t\n"
+        ".hidden _ZdaPvmSt11align_val_t\n"
+        ".hidden _ZdlPvRKSt9nothrow_t\n"
+        ".hidden _ZdaPvRKSt9nothrow_t\n"
+        ".hidden _ZdlPvSt11align_val_tRKSt9nothrow_t\n"
+        ".hidden _ZdaPvSt11align_val_tRKSt9nothrow_t\n");
+#endif
+#undef EQ_AUDIT_DEFAULT
+#endif
+
+AudioThreadAudit::ScopedAudioThread::ScopedAudioThread(bool shouldAudit) noexcept
+    : wasAuditing(isAuditing)
+{
+    isAuditing = shouldAudit;
+}
+
+AudioThreadAudit::ScopedAudioThread::~ScopedAudioThread() noexcept
+{
+    isAuditing = wasAuditing;
+}
+
+AudioThreadAudit::Violations AudioThreadAudit::getViolations() noexcept
+{
+    return { numHeapOperations.load(), numLocks.load() };
+}
+
+#else
+
+AudioThreadAudit::Violations AudioThreadAudit::getViolations() noexcept
+{
+    return {};
+}
+
+#endif
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    AudioThreadAudit.h
+
+    Debug check that the audio thread never touches the heap or blocks on a lock.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Set EQ_AUDIT_AUDIO_THREAD=1 in a debug build to hook the allocator and the blocking locks.
+// Any allocation, free or lock made inside a ScopedAudioThread then hits a jassert (once per
+// kind) and is counted. Every platform sees the same calls made from the plugin's own code:
+// new/delete and malloc/calloc/realloc/free, and blocking mutex and read-write lock
+// acquisitions (which juce::CriticalSection and std::mutex use). Try-locks aren't counted.
+// MSVC gets these through the debug CRT's alloc hook and the import tables of this module and
+// of msvcp140, which std::mutex locks through. Other platforms get them through hidden
+// replacements of the C functions and operator new/delete, which forward to whatever the rest
+// of the process uses. The Linux Makefile's Debug configuration builds that path.
+#ifndef EQ_AUDIT_AUDIO_THREAD
+ #define EQ_AUDIT_AUDIO_THREAD 0
+#endif
+
+#if JUCE_DEBUG && EQ_AUDIT_AUDIO_THREAD
+ #define EQ_AUDIO_THREAD_AUDIT_ENABLED 1
+#else
+ #define EQ_AUDIO_THREAD_AUDIT_ENABLED 0
+#endif
+
+namespace AudioThreadAudit
+{
+    // Marks the calling thread as the audio thread for the lifetime of this object
+    struct ScopedAudioThread
+    {
+       #if EQ_AUDIO_THREAD_AUDIT_ENABLED
+        explicit ScopedAudioThread(bool shouldAudit) noexcept;
+        ~ScopedAudioThread() noexcept;
+
+    private:
+        bool wasAuditing;
+       #else
+        explicit ScopedAudioThread(bool) noexcept {}
+       #endif
+    };
+
+    struct Violations
+    {
+        int heapOperations = 0, locks = 0;
+    };
+
+    // What was caught on the audio thread so far (always nothing when the audit is off)
+    Violations getViolations() noexcept;
+}
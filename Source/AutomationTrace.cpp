@@ -0,0 +1,233 @@
+/*
+  ==============================================================================
+
+    AutomationTrace.cpp
+
+    Compact binary trace of parameter changes and blocks, for replaying a session offline.
+
+  ==============================================================================
+*/
+
+#include "AutomationTrace.h"
+
+namespace
+{
+    using AutomationTrace::Event;
+
+    constexpr const char* magic = "EQTR";
+    constexpr int version = 1;
+    constexpr int eventSize = 16;
+
+    void writeEvent(juce::OutputStream& output, const Event& event)
+    {
+        output.writeByte((char) event.type);
+        output.writeByte((char) event.parameterIndex);
+        output.writeByte((char) event.numChannels);
+        output.writeByte((char) event.flags);
+        output.writeInt(event.numSamples);
+
+        if (event.type == Event::block)
+            output.writeInt64(event.microseconds);
+        else
+            output.writeDouble(event.value);
+    }
+
+    Event readEvent(juce::InputStream& input)
+    {
+        Event event;
+        event.type = (Event::Type) (juce::uint8) input.readByte();
+        event.parameterIndex = (juce::uint8) input.readByte();
+        event.numChannels = (juce::uint8) input.readByte();
+        event.flags = (juce::uint8) input.readByte();
+        event.numSamples = input.readInt();
+
+        if (event.type == Event::block)
+            event.microseconds = input.readInt64();
+        else
+            event.value = input.readDouble();
+
+        return event;
+    }
+}
+
+bool AutomationTrace::read(const juce::File& file, Trace& trace)
+{
+    juce::FileInputStream input(file);
+
+    if (input.failedToOpen())
+        return false;
+
+    char header[4];
+
+    if (input.read(header, 4) != 4 || std::memcmp(header, magic, 4) != 0 || input.readInt() != version)
+        return false;
+
+    auto numParameters = input.readInt();
+
+    if (numParameters < 0 || numParameters > 256)
+        return false;
+
+    trace.parameterIDs.clear();
+    trace.events.clear();
+
+    for (int i = 0; i < numParameters; ++i)
+        trace.parameterIDs.add(input.readString());
+
+    trace.events.reserve((size_t) (input.getNumBytesRemaining() / eventSize));
+
+    // A trace cut short by a crash just ends at its last whole event
+    while (input.getNumBytesRemaining() >= eventSize)
+        trace.events.push_back(readEvent(input));
+
+    return true;
+}
+
+AutomationRecorder::WriterThread::WriterThread()
+    : juce::TimeSliceThread("Automation trace")
+{
+    startThread();
+}
+
+AutomationRecorder::WriterThread::~WriterThread()
+{
+    stopThread(2000);
+}
+
+AutomationRecorder::AutomationRecorder(const juce::File& traceFile, juce::AudioProcessorValueTreeState& apvts)
+    : events((size_t) fifoSize)
+{
+    // NaN never compares equal, so the first block records every parameter's starting value
+    recordedValues.fill(std::numeric_limits<float>::quiet_NaN());
+
+    juce::StringArray parameterIDs;
+
+    for (auto* parameter : apvts.processor.getParameters())
+    {
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+        {
+            jassert(parameters.size() < (size_t) maxParameters);
+
+            if (parameters.size() < (size_t) maxParameters)
+            {
+                parameterIDs.add(withID->paramID);
+                parameters.push_back(apvts.getRawParameterValue(withID->paramID));
+            }
+        }
+    }
+
+    traceFile.deleteFile();
+    stream = traceFile.createOutputStream();
+
+    if (stream == nullptr || stream->failedToOpen())
+    {
+        stream.reset();
+        return;
+    }
+
+    stream->write(magic, 4);
+    stream->writeInt(version);
+    stream->writeInt(parameterIDs.size());
+
+    for (auto& parameterID : parameterIDs)
+        stream->writeString(parameterID);
+
+    startTicks = juce::Time::getHighResolutionTicks();
+    writerThread->addTimeSliceClient(this);
+}
+
+AutomationRecorder::~AutomationRecorder()
+{
+    // Waits for a write in progress, after which whatever is left is written here
+    writerThread->removeTimeSliceClient(this);
+
+    if (stream != nullptr)
+        writeEvents();
+
+    if (auto dropped = droppedBlocks.load())
+        DBG("Automation trace: " << dropped << " blocks dropped (the writer fell behind)");
+}
+
+std::unique_ptr<AutomationRecorder> AutomationRecorder::createFromEnvironment(juce::AudioProcessorValueTreeState& apvts)
+{
+    auto folder = juce::SystemStats::getEnvironmentVariable(environmentVariable, {});
+
+    if (folder.isEmpty())
+        return {};
+
+    auto directory = juce::File::getCurrentWorkingDirectory().getChildFile(folder);
+
+    if (directory.createDirectory().failed())
+        return {};
+
+    auto name = juce::String(JucePlugin_Name) + " " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S");
+    auto recorder = std::make_unique<AutomationRecorder>(directory.getNonexistentChildFile(name, ".eqtrace", false), apvts);
+
+    if (! recorder->isRecording())
+        return {};
+
+    return recorder;
+}
+
+void AutomationRecorder::recordBlock(int numSamples, int numChannels, double sampleRate, bool isNonRealtime) noexcept
+{
+    // Everything this block needs is collected first, so it goes into the FIFO whole or not at all
+    std::array<Event, maxParameters + 2> pending;
+    std::array<float, maxParameters> values;
+    size_t numPending = 0;
+
+    if (sampleRate != recordedSampleRate)
+    {
+        auto& event = pending[numPending++];
+        event.type = Event::sampleRate;
+        event.value = sampleRate;
+    }
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        values[i] = parameters[i]->load();
+
+        if (values[i] != recordedValues[i])
+        {
+            auto& event = pending[numPending++];
+            event.type = Event::parameter;
+            event.parameterIndex = (juce::uint8) i;
+            event.value = values[i];
+        }
+    }
+
+    auto& block = pending[numPending++];
+    block.type = Event::block;
+    block.numSamples = numSamples;
+    block.numChannels = (juce::uint8) numChannels;
+    block.flags = (juce::uint8) (isNonRealtime ? Event::nonRealtime : 0);
+    block.microseconds = (juce::int64) (juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1.0e6);
+
+    // The recorded values stay as they were, so these changes go out with a later block
+    if (fifo.getFreeSpace() < (int) numPending)
+    {
+        ++droppedBlocks;
+        return;
+    }
+
+    const auto scope = fifo.write((int) numPending);
+    size_t next = 0;
+    scope.forEach([this, &pending, &next](int index) { events[(size_t) index] = pending[next++]; });
+
+    recordedSampleRate = sampleRate;
+    std::copy(values.begin(), values.begin() + (std::ptrdiff_t) parameters.size(), recordedValues.begin());
+}
+
+int AutomationRecorder::useTimeSlice()
+{
+    writeEvents();
+    return 100;
+}
+
+void AutomationRecorder::writeEvents()
+{
+    const auto scope = fifo.read(fifo.getNumReady());
+    scope.forEach([this](int index) { writeEvent(*stream, events[(size_t) index]); });
+
+    // Keep the file usable if the host crashes
+    stream->flush();
+}
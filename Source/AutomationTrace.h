@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    AutomationTrace.h
+
+    Compact binary trace of parameter changes and blocks, for replaying a session offline.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace AutomationTrace
+{
+    // One fixed-size record. The file is a header (magic, version, parameter IDs) followed by
+    // these, little-endian: type, parameter, channels, flags (1 byte each), numSamples (4),
+    // then the value, sample rate or timestamp (8).
+    struct Event
+    {
+        enum Type : juce::uint8
+        {
+            block = 1,          // numSamples, numChannels, flags, microseconds since recording started
+            parameter = 2,      // parameter index and its new value (in real units)
+            sampleRate = 3      // the sample rate of the blocks that follow
+        };
+
+        enum Flags : juce::uint8
+        {
+            nonRealtime = 1
+        };
+
+        Type type = block;
+        juce::uint8 parameterIndex = 0, numChannels = 0, flags = 0;
+        juce::int32 numSamples = 0;
+
+        union
+        {
+            double value = 0;
+            juce::int64 microseconds;
+        };
+    };
+
+    struct Trace
+    {
+        juce::StringArray parameterIDs;
+        std::vector<Event> events;
+    };
+
+    // Read a whole trace (false if the file isn't one)
+    bool read(const juce::File& file, Trace& trace);
+}
+
+// Records a trace from the audio thread without locking or allocating.
+// Events go through a FIFO that one writer thread, shared by every recorder in the process,
+// empties into the file. A block whose events don't fit is dropped whole, so the parameter
+// state in the file stays consistent.
+class AutomationRecorder : private juce::TimeSliceClient
+{
+public:
+    AutomationRecorder(const juce::File& traceFile, juce::AudioProcessorValueTreeState& apvts);
+    ~AutomationRecorder() override;
+
+    // Set this environment variable to a folder to have every instance record a trace there
+    static constexpr const char* environmentVariable = "EQ_AUTOMATION_TRACE";
+
+    // A recorder writing a new trace in that folder, or nullptr if the variable isn't set
+    static std::unique_ptr<AutomationRecorder> createFromEnvironment(juce::AudioProcessorValueTreeState& apvts);
+
+    bool isRecording() const { return stream != nullptr; }
+
+    // Audio thread: note the block about to be processed, after any parameters that moved since the last one
+    void recordBlock(int numSamples, int numChannels, double sampleRate, bool isNonRealtime) noexcept;
+
+private:
+    // Services all the recorders' files, so a session full of instances adds one thread, not one each
+    class WriterThread : public juce::TimeSliceThread
+    {
+    public:
+        WriterThread();
+        ~WriterThread() override;
+    };
+
+    int useTimeSlice() override;
+    void writeEvents();
+
+    static constexpr int fifoSize = 1 << 15;
+    static constexpr int maxParameters = 32;
+
+    juce::SharedResourcePointer<WriterThread> writerThread;
+    std::unique_ptr<juce::FileOutputStream> stream;
+
+    // Raw values as getChainParameters() reads them, and what was last recorded for each
+    std::vector<std::atomic<float>*> parameters;
+    std::array<float, maxParameters> recordedValues;
+    double recordedSampleRate = 0;
+
+    juce::AbstractFifo fifo{ fifoSize };
+    std::vector<AutomationTrace::Event> events;
+
+    juce::int64 startTicks = 0;
+    std::atomic<int> droppedBlocks{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AutomationRecorder)
+};
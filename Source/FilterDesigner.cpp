@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    FilterDesigner.cpp
+
+    Allocation-free filter designs that are safe to run on the audio thread.
+
+  ==============================================================================
+*/
+
+#include "FilterDesigner.h"
+
+namespace
+{
+    // Normalise by a0 and narrow to float
+    BiquadCoefficients makeBiquad(double b0, double b1, double b2, double a0, double a1, double a2) noexcept
+    {
+        auto invA0 = 1.0 / a0;
+
+        return { (float) (b0 * invA0), (float) (b1 * invA0), (float) (b2 * invA0),
+                 (float) (a1 * invA0), (float) (a2 * invA0) };
+    }
+
+    // Q of each second order section of an even order Butterworth filter
+    double getButterworthQuality(int section, int numSections) noexcept
+    {
+        auto order = 2.0 * numSections;
+        return 1.0 / (2.0 * std::cos((2.0 * section + 1.0) * juce::MathConstants<double>::pi / (2.0 * order)));
+    }
+
+    CutCoefficients designButterworth(double sampleRate, float frequency, int numSections, bool isHighPass) noexcept
+    {
+        jassert(sampleRate > 0 && frequency > 0 && frequency < sampleRate * 0.5);
+
+        CutCoefficients sections;
+        numSections = juce::jlimit(1, (int) sections.size(), numSections);
+
+        // Every section shares the cutoff, only Q differs
+        auto tanW = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        auto n = isHighPass ? tanW : 1.0 / tanW;
+        auto nSquared = n * n;
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            auto invQ = 1.0 / getButterworthQuality(i, numSections);
+            auto a1 = isHighPass ? 2.0 * (nSquared - 1.0) : 2.0 * (1.0 - nSquared);
+
+            sections[(size_t) i] = makeBiquad(1.0, isHighPass ? -2.0 : 2.0, 1.0,
+                                              1.0 + invQ * n + nSquared, a1, 1.0 - invQ * n + nSquared);
+        }
+
+        return sections;
+    }
+
+    // Poles of the analog section mapped by impulse invariance, plus the terms the matched zeros are solved from
+    struct MatchedPoles
+    {
+        double a1, a2;
+        double A0, A1, A2;
+        double phi0, phi1, phi2;
+    };
+
+    MatchedPoles getMatchedPoles(double w0, double quality) noexcept
+    {
+        MatchedPoles p;
+
+        auto zeta = 1.0 / (2.0 * quality);
+        auto decay = std::exp(-zeta * w0);
+
+        p.a2 = decay * decay;
+        p.a1 = zeta <= 1.0 ? -2.0 * decay * std::cos(std::sqrt(1.0 - zeta * zeta) * w0)
+                           : -2.0 * decay * std::cosh(std::sqrt(zeta * zeta - 1.0) * w0);
+
+        p.A0 = (1.0 + p.a1 + p.a2) * (1.0 + p.a1 + p.a2);
+        p.A1 = (1.0 - p.a1 + p.a2) * (1.0 - p.a1 + p.a2);
+        p.A2 = -4.0 * p.a2;
+
+        auto sinHalf = std::sin(w0 / 2.0);
+        p.phi1 = sinHalf * sinHalf;
+        p.phi0 = 1.0 - p.phi1;
+        p.phi2 = 4.0 * p.phi0 * p.phi1;
+
+        return p;
+    }
+
+    double getAngularFrequency(double sampleRate, float frequency) noexcept
+    {
+        jassert(sampleRate > 0 && frequency > 0 && frequency < sampleRate * 0.5);
+        return 2.0 * juce::MathConstants<double>::pi * frequency / sampleRate;
+    }
+
+    BiquadCoefficients designMatchedLowPassSection(double w0, double quality) noexcept
+    {
+        auto p = getMatchedPoles(w0, quality);
+
+        auto R1 = (p.A0 * p.phi0 + p.A1 * p.phi1 + p.A2 * p.phi2) * quality * quality;
+        auto B0 = p.A0;
+        auto B1 = juce::jmax(0.0, (R1 - B0 * p.phi0) / p.phi1);
+
+        auto b0 = 0.5 * (std::sqrt(B0) + std::sqrt(B1));
+        auto b1 = std::sqrt(B0) - b0;
+
+        return makeBiquad(b0, b1, 0.0, 1.0, p.a1, p.a2);
+    }
+
+    BiquadCoefficients designMatchedHighPassSection(double w0, double quality) noexcept
+    {
+        auto p = getMatchedPoles(w0, quality);
+
+        auto b0 = std::sqrt(p.A0 * p.phi0 + p.A1 * p.phi1 + p.A2 * p.phi2) * quality / (4.0 * p.phi1);
+
+        return makeBiquad(b0, -2.0 * b0, b0, 1.0, p.a1, p.a2);
+    }
+
+    CutCoefficients designMatchedButterworth(double sampleRate, float frequency, int numSections, bool isHighPass) noexcept
+    {
+        CutCoefficients sections;
+        numSections = juce::jlimit(1, (int) sections.size(), numSections);
+
+        auto w0 = getAngularFrequency(sampleRate, frequency);
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            auto quality = getButterworthQuality(i, numSections);
+            sections[(size_t) i] = isHighPass ? designMatchedHighPassSection(w0, quality)
+                                              : designMatchedLowPassSection(w0, quality);
+        }
+
+        return sections;
+    }
+}
+
+BiquadCoefficients designPeak(double sampleRate, float frequency, float quality, float gainFactor) noexcept
+{
+    jassert(sampleRate > 0 && quality > 0);
+
+    auto A = std::sqrt(juce::jmax(0.0, (double) gainFactor));
+    auto omega = 2.0 * juce::MathConstants<double>::pi * juce::jmax((double) frequency, 2.0) / sampleRate;
+    auto alpha = std::sin(omega) / (2.0 * quality);
+    auto c2 = -2.0 * std::cos(omega);
+
+    return makeBiquad(1.0 + alpha * A, c2, 1.0 - alpha * A, 1.0 + alpha / A, c2, 1.0 - alpha / A);
+}
+
+CutCoefficients designButterworthHighPass(double sampleRate, float frequency, int numSections) noexcept
+{
+    return designButterworth(sampleRate, frequency, numSections, true);
+}
+
+CutCoefficients designButterworthLowPass(double sampleRate, float frequency, int numSections) noexcept
+{
+    return designButterworth(sampleRate, frequency, numSections, false);
+}
+
+BiquadCoefficients designMatchedPeak(double sampleRate, float frequency, float quality, float gainFactor) noexcept
+{
+    jassert(quality > 0 && gainFactor > 0);
+
+    // Same analog prototype as designPeak: the poles have Q * sqrt(gain), the zeros Q / sqrt(gain)
+    auto w0 = getAngularFrequency(sampleRate, juce::jmax(frequency, 2.f));
+    auto G = (double) gainFactor;
+    auto p = getMatchedPoles(w0, quality * std::sqrt(G));
+
+    auto R1 = (p.A0 * p.phi0 + p.A1 * p.phi1 + p.A2 * p.phi2) * G * G;
+    auto R2 = (-p.A0 + p.A1 + 4.0 * (p.phi0 - p.phi1) * p.A2) * G * G;
+
+    auto B0 = p.A0;
+    auto B2 = (R1 - R2 * p.phi1 - B0) / (4.0 * p.phi1 * p.phi1);
+    auto B1 = juce::jmax(0.0, R2 + B0 + 4.0 * (p.phi1 - p.phi0) * B2);
+
+    auto W = 0.5 * (std::sqrt(B0) + std::sqrt(B1));
+    auto b0 = 0.5 * (W + std::sqrt(juce::jmax(0.0, W * W + B2)));
+    auto b1 = 0.5 * (std::sqrt(B0) - std::sqrt(B1));
+    auto b2 = -B2 / (4.0 * b0);
+
+    return makeBiquad(b0, b1, b2, 1.0, p.a1, p.a2);
+}
+
+CutCoefficients designMatchedButterworthHighPass(double sampleRate, float frequency, int numSections) noexcept
+{
+    return designMatchedButterworth(sampleRate, frequency, numSections, true);
+}
+
+CutCoefficients designMatchedButterworthLowPass(double sampleRate, float frequency, int numSections) noexcept
+{
+    return designMatchedButterworth(sampleRate, frequency, numSections, false);
+}
+
+BiquadCoefficients designLoudnessShelf(double sampleRate) noexcept
+{
+    // BS.1770 states the 48 kHz coefficients, these are the analog values they come from
+    constexpr double frequency = 1681.974450955533;
+    constexpr double gainDb = 3.999843853973347;
+    constexpr double quality = 0.7071752369554196;
+
+    auto K = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    auto Vh = std::pow(10.0, gainDb / 20.0);
+    auto Vb = std::pow(Vh, 0.4996667741545416);
+
+    return makeBiquad(Vh + Vb * K / quality + K * K, 2.0 * (K * K - Vh), Vh - Vb * K / quality + K * K,
+                      1.0 + K / quality + K * K, 2.0 * (K * K - 1.0), 1.0 - K / quality + K * K);
+}
+
+BiquadCoefficients designLoudnessHighPass(double sampleRate) noexcept
+{
+    constexpr double frequency = 38.13547087602444;
+    constexpr double quality = 0.5003270373238773;
+
+    auto K = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    auto a0 = 1.0 + K / quality + K * K;
+
+    // The standard leaves the numerator at (1, -2, 1) rather than normalising it
+    return makeBiquad(a0, -2.0 * a0, a0, a0, 2.0 * (K * K - 1.0), 1.0 - K / quality + K * K);
+}
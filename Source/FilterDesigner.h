@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    FilterDesigner.h
+
+    Allocation-free filter designs that are safe to run on the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Biquad normalised so a0 == 1, in the same order juce::dsp::IIR::Coefficients stores them
+struct BiquadCoefficients
+{
+    float b0{ 1 }, b1{ 0 }, b2{ 0 }, a1{ 0 }, a2{ 0 };
+};
+
+// Cut filter sections (one biquad per 12 db/Oct, up to 48 db/Oct)
+using CutCoefficients = std::array<BiquadCoefficients, 4>;
+
+// Peak filter (same response as juce::dsp::IIR::Coefficients::makePeakFilter)
+BiquadCoefficients designPeak(double sampleRate, float frequency, float quality, float gainFactor) noexcept;
+
+// Butterworth cascades (same response as juce::dsp::FilterDesign's HighOrderButterworthMethod).
+// Only the first numSections entries are filled in, the rest stay pass-through.
+CutCoefficients designButterworthHighPass(double sampleRate, float frequency, int numSections) noexcept;
+CutCoefficients designButterworthLowPass(double sampleRate, float frequency, int numSections) noexcept;
+
+// Analog-matched versions of the above (M. Vicanek, "Matched Second Order Digital Filters").
+// Poles are mapped exactly and the zeros are fitted to the analog magnitude, so the shape
+// no longer cramps towards Nyquist. Same biquad cost as the bilinear designs.
+BiquadCoefficients designMatchedPeak(double sampleRate, float frequency, float quality, float gainFactor) noexcept;
+CutCoefficients designMatchedButterworthHighPass(double sampleRate, float frequency, int numSections) noexcept;
+CutCoefficients designMatchedButterworthLowPass(double sampleRate, float frequency, int numSections) noexcept;
+
+// ITU-R BS.1770 K-weighting: the high shelf pre-filter, followed by the RLB high pass
+BiquadCoefficients designLoudnessShelf(double sampleRate) noexcept;
+BiquadCoefficients designLoudnessHighPass(double sampleRate) noexcept;
@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+
+    Spreads non-realtime (bounce) renders across a thread pool.
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+namespace
+{
+    // Point a cut filter link at the same coefficients and bypass state as the source
+    template<int Idx>
+    void shareLink(CutFilter& dest, CutFilter& source)
+    {
+        dest.get<Idx>().coefficients = source.get<Idx>().coefficients;
+        dest.setBypassed<Idx>(source.isBypassed<Idx>());
+    }
+
+    void shareCutFilter(CutFilter& dest, CutFilter& source)
+    {
+        shareLink<0>(dest, source);
+        shareLink<1>(dest, source);
+        shareLink<2>(dest, source);
+        shareLink<3>(dest, source);
+    }
+
+    // Make a spare chain run the same filters as the main chain
+    void shareChainSettings(MonoChain& dest, MonoChain& source)
+    {
+        shareCutFilter(dest.get<ChainPositions::LowCut>(), source.get<ChainPositions::LowCut>());
+        shareCutFilter(dest.get<ChainPositions::HighCut>(), source.get<ChainPositions::HighCut>());
+        dest.get<ChainPositions::Peak>().coefficients = source.get<ChainPositions::Peak>().coefficients;
+
+        dest.setBypassed<ChainPositions::LowCut>(source.isBypassed<ChainPositions::LowCut>());
+        dest.setBypassed<ChainPositions::Peak>(source.isBypassed<ChainPositions::Peak>());
+        dest.setBypassed<ChainPositions::HighCut>(source.isBypassed<ChainPositions::HighCut>());
+    }
+
+    // Magnitude of a biquad's larger pole, the roots of z^2 + a1 z + a2
+    double getPoleRadius(const Filter& filter)
+    {
+        auto& raw = filter.coefficients->coefficients;
+
+        if (raw.size() != 5)
+            return 0;
+
+        const double a1 = raw[3], a2 = raw[4];
+        const auto discriminant = a1 * a1 - 4.0 * a2;
+
+        if (discriminant < 0)
+            return std::sqrt(a2);
+
+        const auto root = std::sqrt(discriminant);
+        return 0.5 * juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root));
+    }
+
+    double getPoleRadius(CutFilter& cut)
+    {
+        auto radius = 0.0;
+
+        if (! cut.isBypassed<0>()) radius = juce::jmax(radius, getPoleRadius(cut.get<0>()));
+        if (! cut.isBypassed<1>()) radius = juce::jmax(radius, getPoleRadius(cut.get<1>()));
+        if (! cut.isBypassed<2>()) radius = juce::jmax(radius, getPoleRadius(cut.get<2>()));
+        if (! cut.isBypassed<3>()) radius = juce::jmax(radius, getPoleRadius(cut.get<3>()));
+
+        return radius;
+    }
+
+    // The slowest-decaying pole of everything the chain runs
+    double getPoleRadius(MonoChain& chain)
+    {
+        auto radius = 0.0;
+
+        if (! chain.isBypassed<ChainPositions::LowCut>())
+            radius = juce::jmax(radius, getPoleRadius(chain.get<ChainPositions::LowCut>()));
+
+        if (! chain.isBypassed<ChainPositions::Peak>())
+            radius = juce::jmax(radius, getPoleRadius(chain.get<ChainPositions::Peak>()));
+
+        if (! chain.isBypassed<ChainPositions::HighCut>())
+            radius = juce::jmax(radius, getPoleRadius(chain.get<ChainPositions::HighCut>()));
+
+        return radius;
+    }
+}
+
+void OfflineRenderer::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    maxWarmUpSamples = juce::roundToInt(spec.sampleRate * maxWarmUpSeconds);
+    warmUpSamples = 0;
+
+    // One spare chain per extra segment, for each channel
+    const auto numSpareChains = numThreads - 1;
+
+    for (auto& chains : segmentChains)
+    {
+        chains.resize((size_t) numSpareChains);
+
+        // Sized for biquads up front, like the main chains, so no bounce resizes their state
+        for (auto& chain : chains)
+        {
+            prepareCoefficients(chain);
+            chain.prepare(spec);
+        }
+    }
+
+   #if JUCE_USE_SIMD
+    segmentEngines.resize((size_t) numSpareChains);
+   #endif
+
+    warmUpBuffer.setSize((int) segmentChains.size() * juce::jmax(1, numSpareChains), juce::jmax(1, maxWarmUpSamples));
+
+    tasks.ensureStorageAllocated((int) segmentChains.size() * numThreads);
+}
+
+int OfflineRenderer::getNumSegments(int numChannels, int numSamples) const
+{
+    if (warmUpSamples <= 0)
+        return 1;
+
+    // Threads left over once every channel has one, and segments long enough to amortise the warm-up
+    auto bySpareThreads = juce::jmax(1, numThreads / juce::jmax(1, numChannels));
+    auto byLength = juce::jmax(1, numSamples / juce::jmax(1, warmUpSamples * minSegmentWarmUps));
+
+    return juce::jmin(bySpareThreads, byLength);
+}
+
+bool OfflineRenderer::shouldRender(const juce::dsp::AudioBlock<float>& block, const std::array<MonoChain*, 2>& chains)
+{
+    auto numChannels = juce::jmin((int) block.getNumChannels(), (int) segmentChains.size());
+    auto numSamples = (int) block.getNumSamples();
+
+    if (numSamples < minParallelBlockSize)
+        return false;
+
+    // Samples until the slowest pole has decayed far enough: r^n below warmUpDecayDb
+    auto radius = 0.0;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        radius = juce::jmax(radius, getPoleRadius(*chains[(size_t) channel]));
+
+    const auto decay = juce::Decibels::decibelsToGain(warmUpDecayDb, -200.0);
+    warmUpSamples = 0;
+
+    if (radius < 1.0)
+    {
+        auto needed = radius > decay ? std::ceil(std::log(decay) / std::log(radius)) : 1.0;
+
+        // The zeros need some input history too, however quickly the poles decay
+        if (needed <= (double) maxWarmUpSamples)
+            warmUpSamples = juce::jmax(64, (int) needed);
+    }
+
+    return numChannels * getNumSegments(numChannels, numSamples) > 1;
+}
+
+void OfflineRenderer::process(juce::dsp::AudioBlock<float>& block, const std::array<MonoChain*, 2>& chains)
+{
+    auto numChannels = juce::jmin((int) block.getNumChannels(), (int) chains.size());
+    auto numSamples = (int) block.getNumSamples();
+    auto numSegments = getNumSegments(numChannels, numSamples);
+    auto segmentLength = numSamples / numSegments;
+
+    tasks.clearQuick();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = block.getChannelPointer((size_t) channel);
+
+        // The first segment continues from the main chain's state
+        tasks.add({ chains[(size_t) channel], samples, segmentLength, nullptr, 0 });
+
+        for (int segment = 1; segment < numSegments; ++segment)
+        {
+            auto start = segment * segmentLength;
+            auto length = (segment == numSegments - 1) ? numSamples - start : segmentLength;
+
+            auto& chain = segmentChains[(size_t) channel][(size_t) segment - 1];
+            shareChainSettings(chain, *chains[(size_t) channel]);
+            chain.reset();
+
+            // Copy the warm-up audio now, before the previous segment overwrites it
+            auto* warmUp = warmUpBuffer.getWritePointer(channel * (numThreads - 1) + segment - 1);
+            juce::FloatVectorOperations::copy(warmUp, samples + start - warmUpSamples, warmUpSamples);
+
+            tasks.add({ &chain, samples + start, length, warmUp, warmUpSamples });
+        }
+    }
+
+    threads->runParallel(tasks.size(), [this](int index) { runTask(tasks.getReference(index)); });
+
+    // The chain that ran the last segment now holds the state to carry into the next block
+    if (numSegments > 1)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            std::swap(*chains[(size_t) channel], segmentChains[(size_t) channel][(size_t) numSegments - 2]);
+    }
+}
+
+#if JUCE_USE_SIMD
+void OfflineRenderer::process(juce::dsp::AudioBlock<float>& block, StateSpaceCascade& engine, MonoChain& chain)
+{
+    auto numSamples = (int) block.getNumSamples();
+    auto numSegments = getNumSegments(1, numSamples);
+    auto segmentLength = numSamples / numSegments;
+    auto* samples = block.getChannelPointer(0);
+
+    tasks.clearQuick();
+
+    // The first segment continues from the engine's state
+    engine.setSections(chain);
+    tasks.add({ nullptr, samples, segmentLength, nullptr, 0, &engine });
+
+    for (int segment = 1; segment < numSegments; ++segment)
+    {
+        auto start = segment * segmentLength;
+        auto length = (segment == numSegments - 1) ? numSamples - start : segmentLength;
+
+        auto& spare = segmentEngines[(size_t) segment - 1];
+        spare.setSections(chain);
+        spare.reset();
+
+        auto* warmUp = warmUpBuffer.getWritePointer(segment - 1);
+        juce::FloatVectorOperations::copy(warmUp, samples + start - warmUpSamples, warmUpSamples);
+
+        tasks.add({ nullptr, samples + start, length, warmUp, warmUpSamples, &spare });
+    }
+
+    threads->runParallel(tasks.size(), [this](int index) { runTask(tasks.getReference(index)); });
+
+    // As with the chains, the engine that ran the last segment carries on into the next block
+    if (numSegments > 1)
+        std::swap(engine, segmentEngines[(size_t) numSegments - 2]);
+}
+#endif
+
+void OfflineRenderer::runTask(const Task& task)
+{
+   #if JUCE_USE_SIMD
+    if (task.engine != nullptr)
+    {
+        // Warm up on the preceding audio in the scratch buffer, then run the segment in place
+        if (task.numWarmUp > 0)
+            task.engine->process(task.warmUp, task.numWarmUp);
+
+        task.engine->process(task.samples, task.numSamples);
+        return;
+    }
+   #endif
+
+    if (task.numWarmUp > 0)
+    {
+        // Settle the filter state on the preceding audio, then throw that output away
+        juce::dsp::AudioBlock<float> warmUpBlock(&task.warmUp, 1, (size_t) task.numWarmUp);
+        juce::dsp::ProcessContextReplacing<float> warmUpContext(warmUpBlock);
+        task.chain->process(warmUpContext);
+    }
+
+    juce::dsp::AudioBlock<float> segmentBlock(&task.samples, 1, (size_t) task.numSamples);
+    juce::dsp::ProcessContextReplacing<float> segmentContext(segmentBlock);
+    task.chain->process(segmentContext);
+}
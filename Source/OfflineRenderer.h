@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+
+    Spreads non-realtime (bounce) renders across a thread pool.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "SharedThreadPool.h"
+#include "StateSpaceCascade.h"
+
+// Renders large offline blocks on several threads.
+// Every channel is an independent task. Long blocks are also cut into segments, each run by
+// a spare chain that is first warmed up on the audio preceding it. The warm-up lasts until
+// the slowest pole of the designed filters has decayed by 100 dB, so a segment starts from
+// the serial render's state to within that; filters too resonant for that to fit the budget
+// are only split across channels. A mono bus's block state-space engine is segmented the same
+// way, with spare engines, so a bounce never leaves its state behind.
+class OfflineRenderer
+{
+public:
+    OfflineRenderer() = default;
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    // Is this block big enough to be worth handing to the pool? Call after the chains have been
+    // designed: it works out the warm-up their filters need for process().
+    bool shouldRender(const juce::dsp::AudioBlock<float>& block, const std::array<MonoChain*, 2>& chains);
+
+    // Process each channel of the block through its chain (chains[0] = left, chains[1] = right)
+    void process(juce::dsp::AudioBlock<float>& block, const std::array<MonoChain*, 2>& chains);
+
+   #if JUCE_USE_SIMD
+    // Process a mono block through the engine, with the sections designed in the chain
+    void process(juce::dsp::AudioBlock<float>& block, StateSpaceCascade& engine, MonoChain& chain);
+   #endif
+
+private:
+    struct Task
+    {
+        MonoChain* chain = nullptr;
+        float* samples = nullptr;
+        int numSamples = 0;
+
+        // Audio preceding the segment, used to settle the filter state
+        float* warmUp = nullptr;
+        int numWarmUp = 0;
+
+       #if JUCE_USE_SIMD
+        // Runs the segment instead of the chain when set
+        StateSpaceCascade* engine = nullptr;
+       #endif
+    };
+
+    int getNumSegments(int numChannels, int numSamples) const;
+
+    static void runTask(const Task& task);
+
+    // Blocks smaller than this are cheaper to process serially than to hand off
+    static constexpr int minParallelBlockSize = 2048;
+
+    // How far the slowest pole must decay during a warm-up, the longest warm-up allowed,
+    // and the shortest segment we split off (in warm-ups)
+    static constexpr double warmUpDecayDb = -100.0;
+    static constexpr double maxWarmUpSeconds = 1.0;
+    static constexpr int minSegmentWarmUps = 4;
+
+    juce::SharedResourcePointer<SharedThreadPool> threads;
+    const int numThreads = threads->getConcurrency();
+
+    // Warm-up the current filters need (0 when they can't be segmented)
+    int warmUpSamples = 0;
+    int maxWarmUpSamples = 0;
+
+    // Spare chains (numThreads - 1 per channel) and their warm-up scratch buffers
+    std::array<std::vector<MonoChain>, 2> segmentChains;
+    juce::AudioBuffer<float> warmUpBuffer;
+
+   #if JUCE_USE_SIMD
+    // Spare engines for mono blocks (numThreads - 1)
+    std::vector<StateSpaceCascade> segmentEngines;
+   #endif
+
+    juce::Array<Task> tasks;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineRenderer)
+};
@@ -0,0 +1,292 @@
+/*
+  ==============================================================================
+
+    OutputMeter.cpp
+
+    Peak, RMS and loudness (LUFS) metering of the processed output.
+
+  ==============================================================================
+*/
+
+#include "OutputMeter.h"
+
+#if JUCE_USE_SIMD
+
+namespace
+{
+    using WeightingState = std::array<double, 4>;
+
+    // One sample through the shelf and then the high pass, in double precision
+    double stepWeighting(const BiquadCoefficients& s, const BiquadCoefficients& h, WeightingState& state, double x) noexcept
+    {
+        auto shelved = s.b0 * x + state[0];
+        state[0] = s.b1 * x - s.a1 * shelved + state[1];
+        state[1] = s.b2 * x - s.a2 * shelved;
+
+        auto y = h.b0 * shelved + state[2];
+        state[2] = h.b1 * shelved - h.a1 * y + state[3];
+        state[3] = h.b2 * shelved - h.a2 * y;
+
+        return y;
+    }
+}
+
+void OutputMeter::WeightingBlock::design(const BiquadCoefficients& shelf, const BiquadCoefficients& highPass)
+{
+    alignas(Register::SIMDRegisterSize) float outputs[blockLength];
+    alignas(Register::SIMDRegisterSize) float nextState[blockLength];
+
+    // The system is linear, so each matrix column is its response to one unit state value
+    // or one unit input, run for a block from rest
+    auto respond = [&](int unitState, int unitInput)
+    {
+        WeightingState state{};
+
+        if (unitState >= 0)
+            state[(size_t) unitState] = 1.0;
+
+        for (int k = 0; k < blockLength; ++k)
+            outputs[k] = (float) stepWeighting(shelf, highPass, state, k == unitInput ? 1.0 : 0.0);
+
+        for (int i = 0; i < blockLength; ++i)
+            nextState[i] = i < 4 ? (float) state[(size_t) i] : 0.f;
+    };
+
+    for (int i = 0; i < 4; ++i)
+    {
+        respond(i, -1);
+        yFromState[(size_t) i] = Register::fromRawArray(outputs);
+        nextFromState[(size_t) i] = Register::fromRawArray(nextState);
+    }
+
+    for (int j = 0; j < blockLength; ++j)
+    {
+        respond(-1, j);
+        yFromInput[(size_t) j] = Register::fromRawArray(outputs);
+        nextFromInput[(size_t) j] = Register::fromRawArray(nextState);
+    }
+}
+
+#endif
+
+void OutputMeter::prepare(double sampleRate, int channelsToMeter)
+{
+    numChannels = juce::jlimit(1, maxChannels, channelsToMeter);
+    stepLength = juce::jmax(1, juce::roundToInt(sampleRate * stepSeconds));
+
+    shelf = designLoudnessShelf(sampleRate);
+    highPass = designLoudnessHighPass(sampleRate);
+
+   #if JUCE_USE_SIMD
+    weightingBlock.design(shelf, highPass);
+   #endif
+
+    resetMeasurement();
+}
+
+void OutputMeter::resetMeasurement() noexcept
+{
+    for (auto& state : weightingState)
+        state.fill(0);
+
+    samplesInStep = 0;
+    stepSquares = 0;
+    stepWeighted = 0;
+
+    squareSteps.fill(0);
+    weightedSteps.fill(0);
+    nextStep = 0;
+    numSteps = 0;
+
+    histogramCounts.fill(0);
+    histogramEnergy.fill(0);
+
+    rmsDb.store(silenceDb);
+    shortTermLufs.store(silenceDb);
+    integratedLufs.store(silenceDb);
+}
+
+void OutputMeter::process(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+    if (resetRequested.exchange(false))
+        resetMeasurement();
+
+    auto channelsInBlock = juce::jmin((int) block.getNumChannels(), numChannels);
+    auto numSamples = (int) block.getNumSamples();
+
+    float blockPeak = 0;
+
+    for (int start = 0; start < numSamples; )
+    {
+        // Measure up to the end of the current step
+        auto length = juce::jmin(numSamples - start, stepLength - samplesInStep);
+
+        measure(block, start, length, channelsInBlock, blockPeak);
+
+        samplesInStep += length;
+        start += length;
+
+        if (samplesInStep == stepLength)
+            completeStep();
+    }
+
+    // Hold the highest peak until the editor reads it
+    auto previousPeak = peak.load();
+    while (blockPeak > previousPeak && ! peak.compare_exchange_weak(previousPeak, blockPeak)) {}
+}
+
+void OutputMeter::measure(const juce::dsp::AudioBlock<float>& block, int start, int length, int channelsInBlock, float& blockPeak) noexcept
+{
+    // Keep the coefficients in registers for the inner loop
+    const auto s = shelf;
+    const auto h = highPass;
+
+    if (channelsInBlock == 2)
+    {
+        auto* leftSamples = block.getChannelPointer(0) + start;
+        auto* rightSamples = block.getChannelPointer(1) + start;
+
+        ChannelMeasurement left(weightingState[0]), right(weightingState[1]);
+        int i = 0;
+
+        // The channels' filters are independent, so running them side by side lets each
+        // one's multiply-adds fill the other's latency
+       #if JUCE_USE_SIMD
+        for (; i + blockLength <= length; i += blockLength)
+        {
+            left.addBlock(leftSamples + i, weightingBlock);
+            right.addBlock(rightSamples + i, weightingBlock);
+        }
+       #endif
+
+        // Leftover samples one at a time, in the same transposed direct form II state
+        for (; i < length; ++i)
+        {
+            left.add(leftSamples[i], s, h);
+            right.add(rightSamples[i], s, h);
+        }
+
+        left.finish(weightingState[0], blockPeak, stepSquares, stepWeighted);
+        right.finish(weightingState[1], blockPeak, stepSquares, stepWeighted);
+    }
+    else if (channelsInBlock == 1)
+    {
+        auto* samples = block.getChannelPointer(0) + start;
+
+        ChannelMeasurement mono(weightingState[0]);
+        int i = 0;
+
+       #if JUCE_USE_SIMD
+        for (; i + blockLength <= length; i += blockLength)
+            mono.addBlock(samples + i, weightingBlock);
+       #endif
+
+        for (; i < length; ++i)
+            mono.add(samples[i], s, h);
+
+        mono.finish(weightingState[0], blockPeak, stepSquares, stepWeighted);
+    }
+}
+
+void OutputMeter::completeStep() noexcept
+{
+    // RMS averages the channels, loudness sums them (BS.1770 weights L and R at 1.0)
+    squareSteps[(size_t) nextStep] = stepSquares / ((double) stepLength * numChannels);
+    weightedSteps[(size_t) nextStep] = stepWeighted / (double) stepLength;
+
+    nextStep = (nextStep + 1) % stepsPerShortTerm;
+    numSteps = juce::jmin(numSteps + 1, stepsPerShortTerm);
+
+    samplesInStep = 0;
+    stepSquares = 0;
+    stepWeighted = 0;
+
+    auto rms = std::sqrt(getMeanOfLastSteps(squareSteps, stepsPerRms));
+    rmsDb.store(juce::Decibels::gainToDecibels((float) rms, silenceDb));
+    shortTermLufs.store(toLufs(getMeanOfLastSteps(weightedSteps, stepsPerShortTerm)));
+
+    if (numSteps >= stepsPerGatingBlock)
+    {
+        // Absolute gate: blocks quieter than -70 LUFS are left out entirely
+        auto blockEnergy = getMeanOfLastSteps(weightedSteps, stepsPerGatingBlock);
+        auto blockLufs = toLufs(blockEnergy);
+
+        if (blockLufs > histogramFloor)
+        {
+            auto bin = juce::jlimit(0, numHistogramBins - 1, (int) ((blockLufs - histogramFloor) / histogramResolution));
+            ++histogramCounts[(size_t) bin];
+            histogramEnergy[(size_t) bin] += blockEnergy;
+
+            updateIntegrated();
+        }
+    }
+}
+
+void OutputMeter::updateIntegrated() noexcept
+{
+    double totalEnergy = 0;
+    int totalCount = 0;
+
+    for (int i = 0; i < numHistogramBins; ++i)
+    {
+        totalEnergy += histogramEnergy[(size_t) i];
+        totalCount += histogramCounts[(size_t) i];
+    }
+
+    // Relative gate: 10 LU below the loudness of everything above the absolute gate
+    auto relativeGate = toLufs(totalEnergy / totalCount) - 10.f;
+
+    double gatedEnergy = 0;
+    int gatedCount = 0;
+
+    for (int i = 0; i < numHistogramBins; ++i)
+    {
+        auto binLufs = histogramFloor + (i + 0.5f) * histogramResolution;
+
+        if (binLufs > relativeGate)
+        {
+            gatedEnergy += histogramEnergy[(size_t) i];
+            gatedCount += histogramCounts[(size_t) i];
+        }
+    }
+
+    if (gatedCount > 0)
+        integratedLufs.store(toLufs(gatedEnergy / gatedCount));
+}
+
+double OutputMeter::getMeanOfLastSteps(const std::array<double, stepsPerShortTerm>& steps, int stepsToAverage) const noexcept
+{
+    // Average whatever is available while the meter is still filling up
+    stepsToAverage = juce::jmin(stepsToAverage, numSteps);
+
+    if (stepsToAverage == 0)
+        return 0;
+
+    double sum = 0;
+
+    for (int i = 1; i <= stepsToAverage; ++i)
+        sum += steps[(size_t) ((nextStep - i + stepsPerShortTerm) % stepsPerShortTerm)];
+
+    return sum / stepsToAverage;
+}
+
+float OutputMeter::toLufs(double energy) noexcept
+{
+    if (energy <= 0)
+        return silenceDb;
+
+    return juce::jmax(silenceDb, (float) (-0.691 + 10.0 * std::log10(energy)));
+}
+
+OutputMeter::Readings OutputMeter::getReadings() noexcept
+{
+    return { juce::Decibels::gainToDecibels(peak.exchange(0), silenceDb),
+             rmsDb.load(),
+             shortTermLufs.load(),
+             integratedLufs.load() };
+}
+
+void OutputMeter::requestReset() noexcept
+{
+    resetRequested.store(true);
+}
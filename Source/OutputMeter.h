@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    OutputMeter.h
+
+    Peak, RMS and loudness (LUFS) metering of the processed output.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterDesigner.h"
+
+// Measures the output on the audio thread and publishes the results through atomics.
+// Peak, RMS and the K-weighted loudness sums all come out of one pass over the block,
+// run while the freshly filtered block is still in cache, with both channels in the same loop.
+// With SIMD the two K-weighting stages run as one four-state system in block state-space form,
+// a SIMD register of samples at a time (like StateSpaceCascade), so the weighting is not held
+// to one filter step per sample. The benchmark's "meter" mode reports what the meter adds to
+// the EQ's own cost at each slope and checks the loudness calibration.
+class OutputMeter
+{
+public:
+    struct Readings
+    {
+        float peakDb, rmsDb, shortTermLufs, integratedLufs;
+    };
+
+    void prepare(double sampleRate, int channelsToMeter);
+
+    // Audio thread: measure a block of processed output
+    void process(const juce::dsp::AudioBlock<float>& block) noexcept;
+
+    // Any thread: latest values (the peak is the highest seen since the previous call)
+    Readings getReadings() noexcept;
+
+    // Any thread: restart the integrated measurement on the next block
+    void requestReset() noexcept;
+
+    // Reported when there is no signal
+    static constexpr float silenceDb = -100.f;
+
+private:
+    static constexpr int maxChannels = 2;
+
+    // Measurements advance in 100 ms steps (BS.1770 gating blocks overlap by 75%)
+    static constexpr double stepSeconds = 0.1;
+    static constexpr int stepsPerRms = 3;
+    static constexpr int stepsPerGatingBlock = 4;
+    static constexpr int stepsPerShortTerm = 30;
+
+    // Gating blocks binned from -70 to +10 LUFS, so the integrated value needs no storage per block
+    static constexpr float histogramFloor = -70.f;
+    static constexpr float histogramResolution = 0.1f;
+    static constexpr int numHistogramBins = 800;
+
+   #if JUCE_USE_SIMD
+    using Register = juce::dsp::SIMDRegister<float>;
+    static constexpr int blockLength = (int) Register::SIMDNumElements;
+
+    // Shelf then high pass as one system whose state is (s1, s2, h1, h2), N samples at a time
+    struct WeightingBlock
+    {
+        void design(const BiquadCoefficients& shelf, const BiquadCoefficients& highPass);
+
+        // Weighted outputs: sum of yFromState[i] * state[i] + sum of yFromInput[j] * u[j]
+        std::array<Register, 4> yFromState;
+        std::array<Register, blockLength> yFromInput;
+
+        // State after the block, in the first four lanes, from the same terms
+        std::array<Register, 4> nextFromState;
+        std::array<Register, blockLength> nextFromInput;
+    };
+
+    static_assert(blockLength >= 4, "The next state needs a lane per state value");
+   #endif
+
+    // One channel's weighting filters and sums, held in locals while a stretch is measured
+    struct ChannelMeasurement
+    {
+        explicit ChannelMeasurement(const std::array<float, 4>& state) noexcept
+            : s1(state[0]), s2(state[1]), h1(state[2]), h2(state[3]) {}
+
+        void add(float x, const BiquadCoefficients& s, const BiquadCoefficients& h) noexcept
+        {
+            peak = juce::jmax(peak, std::abs(x));
+            squares += x * x;
+
+            // K-weighting: shelf, then high pass
+            auto shelved = s.b0 * x + s1;
+            s1 = s.b1 * x - s.a1 * shelved + s2;
+            s2 = s.b2 * x - s.a2 * shelved;
+
+            auto y = h.b0 * shelved + h1;
+            h1 = h.b1 * shelved - h.a1 * y + h2;
+            h2 = h.b2 * shelved - h.a2 * y;
+
+            weighted += y * y;
+        }
+
+       #if JUCE_USE_SIMD
+        void addBlock(const float* x, const WeightingBlock& w) noexcept
+        {
+            // Per lane, so these vectorise and no sum waits on the previous sample
+            for (int j = 0; j < blockLength; ++j)
+            {
+                peakLanes[j] = juce::jmax(peakLanes[j], std::abs(x[j]));
+                squareLanes[j] += x[j] * x[j];
+            }
+
+            // All N weighted outputs at once; the state N samples on is the only serial step
+            auto y = w.yFromState[0] * s1 + w.yFromState[1] * s2 + (w.yFromState[2] * h1 + w.yFromState[3] * h2);
+            auto next = w.nextFromState[0] * s1 + w.nextFromState[1] * s2 + (w.nextFromState[2] * h1 + w.nextFromState[3] * h2);
+
+            for (int j = 0; j < blockLength; ++j)
+            {
+                y += w.yFromInput[(size_t) j] * x[j];
+                next += w.nextFromInput[(size_t) j] * x[j];
+            }
+
+            weightedLanes += y * y;
+
+            alignas(Register::SIMDRegisterSize) float lanes[blockLength];
+            next.copyToRawArray(lanes);
+            s1 = lanes[0];
+            s2 = lanes[1];
+            h1 = lanes[2];
+            h2 = lanes[3];
+        }
+       #endif
+
+        void finish(std::array<float, 4>& state, float& blockPeak, double& stepSquares, double& stepWeighted) const noexcept
+        {
+            state = { s1, s2, h1, h2 };
+            blockPeak = juce::jmax(blockPeak, peak);
+            stepSquares += squares;
+            stepWeighted += weighted;
+
+           #if JUCE_USE_SIMD
+            for (int j = 0; j < blockLength; ++j)
+            {
+                blockPeak = juce::jmax(blockPeak, peakLanes[j]);
+                stepSquares += squareLanes[j];
+            }
+
+            stepWeighted += weightedLanes.sum();
+           #endif
+        }
+
+        float s1, s2, h1, h2;
+        float peak = 0, squares = 0, weighted = 0;
+
+       #if JUCE_USE_SIMD
+        Register weightedLanes = Register::expand(0.f);
+        float peakLanes[blockLength] = {}, squareLanes[blockLength] = {};
+       #endif
+    };
+
+    // Accumulate one stretch of a step, both channels in the same loop
+    void measure(const juce::dsp::AudioBlock<float>& block, int start, int length, int channelsInBlock, float& blockPeak) noexcept;
+
+    void resetMeasurement() noexcept;
+    void completeStep() noexcept;
+    void updateIntegrated() noexcept;
+
+    double getMeanOfLastSteps(const std::array<double, stepsPerShortTerm>& steps, int numSteps) const noexcept;
+    static float toLufs(double energy) noexcept;
+
+    BiquadCoefficients shelf, highPass;
+
+   #if JUCE_USE_SIMD
+    WeightingBlock weightingBlock;
+   #endif
+
+    // Transposed direct form II state of both K-weighting stages, per channel
+    std::array<std::array<float, 4>, maxChannels> weightingState{};
+
+    int numChannels = maxChannels;
+    int stepLength = 1;
+    int samplesInStep = 0;
+
+    // Running sums for the current step
+    double stepSquares = 0, stepWeighted = 0;
+
+    // Mean energy of each of the most recent steps
+    std::array<double, stepsPerShortTerm> squareSteps{}, weightedSteps{};
+    int nextStep = 0, numSteps = 0;
+
+    std::array<int, numHistogramBins> histogramCounts{};
+    std::array<double, numHistogramBins> histogramEnergy{};
+
+    std::atomic<float> peak{ 0 };
+    std::atomic<float> rmsDb{ silenceDb }, shortTermLufs{ silenceDb }, integratedLufs{ silenceDb };
+    std::atomic<bool> resetRequested{ false };
+};
@@ -41,6 +41,10 @@ void FreqCurveComponent::parameterValueChanged(int parameterIndex, float newValu
 // Check if parameters were changed in the callback
 void FreqCurveComponent::timerCallback()
 {
+    // Nothing can be designed until the host has given us a sample rate
+    if (audioProcessor.getSampleRate() <= 0)
+        return;
+
     if (parametersChanged.compareAndSetBool(false, true))
     {
         // Update monoChain
@@ -56,15 +60,20 @@ void FreqCurveComponent::timerCallback()
         updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainParameters.highCutSlope);
 
         // Draw updated frequency curve
+        responseCurveNeedsUpdate = true;
         repaint();
     }
 
 }
 
-void FreqCurveComponent::paint(juce::Graphics& g)
+void FreqCurveComponent::resized()
+{
+    responseCurveNeedsUpdate = true;
+}
+
+void FreqCurveComponent::updateResponseCurve()
 {
     using namespace juce;
-    g.fillAll(Colours::cadetblue);
 
     // Audio curve area
     auto freqCurveArea = getLocalBounds();
@@ -72,9 +81,6 @@ void FreqCurveComponent::paint(juce::Graphics& g)
     // Width of audio curve area
     auto width = freqCurveArea.getWidth();
 
-    // Height of audio curve area
-    auto height = freqCurveArea.getHeight();
-
     // Get chain elements for each filter
     auto& lowcut = monoChain.get<ChainPositions::LowCut>();
     auto& peak = monoChain.get<ChainPositions::Peak>();
@@ -82,7 +88,11 @@ void FreqCurveComponent::paint(juce::Graphics& g)
 
     auto sampleRate = audioProcessor.getSampleRate();
 
-    std::vector<double> magnitudes;
+    responseCurve.clear();
+
+    if (width <= 0)
+        return;
+
     magnitudes.resize(width);
 
     for (int i = 0; i < width; ++i)
@@ -139,8 +149,6 @@ void FreqCurveComponent::paint(juce::Graphics& g)
 
     }
 
-    Path audioFrequencyCurve;
-
     const double minOutput = freqCurveArea.getBottom();
     const double maxOutput = freqCurveArea.getY();
 
@@ -149,12 +157,28 @@ void FreqCurveComponent::paint(juce::Graphics& g)
         return jmap(input, -24.0, 24.0, minOutput, maxOutput);
     };
 
-    audioFrequencyCurve.startNewSubPath(freqCurveArea.getX(), map(magnitudes.front()));
+    responseCurve.startNewSubPath(freqCurveArea.getX(), map(magnitudes.front()));
 
     for (int i = 1; i < magnitudes.size(); ++i)
     {
-        audioFrequencyCurve.lineTo(freqCurveArea.getX() + i, map(magnitudes[i]));
+        responseCurve.lineTo(freqCurveArea.getX() + i, map(magnitudes[i]));
     }
+}
+
+void FreqCurveComponent::paint(juce::Graphics& g)
+{
+    using namespace juce;
+    g.fillAll(Colours::cadetblue);
+
+    // Only recalculate the response when something changed
+    if (responseCurveNeedsUpdate)
+    {
+        updateResponseCurve();
+        responseCurveNeedsUpdate = false;
+    }
+
+    // Audio curve area
+    auto freqCurveArea = getLocalBounds();
 
     // Draw box for the frequency curve
     g.setColour(Colours::black);
@@ -162,20 +186,154 @@ void FreqCurveComponent::paint(juce::Graphics& g)
 
     // Draw the frequency curve
     g.setColour(Colours::beige);
-    g.strokePath(audioFrequencyCurve, PathStrokeType(2.f));
+    g.strokePath(responseCurve, PathStrokeType(2.f));
+}
+
+OutputMeterComponent::OutputMeterComponent(OutputMeter& meter) : outputMeter(meter)
+{
+    startTimerHz(20);
+}
+
+void OutputMeterComponent::timerCallback()
+{
+    readings = outputMeter.getReadings();
+
+    // Drop about 20 dB per second
+    displayedPeakDb = juce::jmax(readings.peakDb, displayedPeakDb - 1.f);
+
+    repaint();
+}
+
+void OutputMeterComponent::mouseDown(const juce::MouseEvent& event)
+{
+    outputMeter.requestReset();
+}
+
+void OutputMeterComponent::paint(juce::Graphics& g)
+{
+    using namespace juce;
+
+    // Show silence as -inf rather than the floor value
+    auto format = [](float value, const char* unit)
+    {
+        if (value <= OutputMeter::silenceDb)
+            return String("-inf ") + unit;
+
+        return String(value, 1) + " " + unit;
+    };
+
+    String text;
+    text << "Peak " << format(displayedPeakDb, "dB")
+         << "    RMS " << format(readings.rmsDb, "dB")
+         << "    Short-term " << format(readings.shortTermLufs, "LUFS")
+         << "    Integrated " << format(readings.integratedLufs, "LUFS");
+
+    g.setColour(displayedPeakDb > 0.f ? Colours::darkred : Colours::black);
+    g.setFont(14.f);
+    g.drawFittedText(text, getLocalBounds(), Justification::centred, 1);
+}
+
+ReferenceMatchComponent::ReferenceMatchComponent(juce::AudioProcessorValueTreeState& state)
+    : juce::Thread("Reference match"), apvts(state)
+{
+    matchButton.onClick = [this] { chooseFiles(); };
+    addAndMakeVisible(matchButton);
+}
+
+ReferenceMatchComponent::~ReferenceMatchComponent()
+{
+    // The analysis stops at its next read once asked to, and only after every one of its pool
+    // tasks has, so this wait is short and nothing is left writing into the thread's stack
+    stopThread(2000);
+}
+
+void ReferenceMatchComponent::resized()
+{
+    matchButton.setBounds(getLocalBounds());
+}
+
+void ReferenceMatchComponent::chooseFiles()
+{
+    if (isThreadRunning())
+        return;
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    auto wildcard = formatManager.getWildcardForAllFormats();
+
+    const auto flags = juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles;
+
+    sourceChooser = std::make_unique<juce::FileChooser>("Choose the track to match", juce::File(), wildcard);
+    sourceChooser->launchAsync(flags, [this, wildcard, flags](const juce::FileChooser& chooser)
+    {
+        sourceFile = chooser.getResult();
+
+        if (sourceFile == juce::File())
+            return;
+
+        referenceChooser = std::make_unique<juce::FileChooser>("Choose the reference mix", sourceFile.getParentDirectory(), wildcard);
+        referenceChooser->launchAsync(flags, [this](const juce::FileChooser& chooser)
+        {
+            referenceFile = chooser.getResult();
+
+            if (referenceFile == juce::File())
+                return;
+
+            // Fit with the design mode the EQ is in now
+            analogMatched = getChainParameters(apvts).analogMatched;
+
+            matchButton.setEnabled(false);
+            matchButton.setButtonText("Analysing...");
+            startThread();
+        });
+    });
+}
+
+void ReferenceMatchComponent::run()
+{
+    ReferenceMatcher matcher;
+    result = matcher.match(sourceFile, referenceFile, analogMatched, [this] { return threadShouldExit(); });
+
+    // Closed while analysing: there is nothing left to apply the result to
+    if (threadShouldExit())
+        return;
+
+    juce::MessageManager::callAsync([safeThis = juce::Component::SafePointer<ReferenceMatchComponent>(this)]
+    {
+        if (safeThis != nullptr)
+            safeThis->applyResult();
+    });
+}
+
+void ReferenceMatchComponent::applyResult()
+{
+    matchButton.setEnabled(true);
+
+    if (! result.succeeded)
+    {
+        matchButton.setButtonText("Match reference...");
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Match reference", result.errorMessage);
+        return;
+    }
+
+    applyChainParameters(apvts, result.parameters);
+    matchButton.setButtonText("Matched (" + juce::String(result.rmsErrorDb, 1) + " dB rms)");
 }
 
 //==============================================================================
 _3BandEqAudioProcessorEditor::_3BandEqAudioProcessorEditor(_3BandEqAudioProcessor& p)
     : AudioProcessorEditor(&p), audioProcessor(p),
 freqCurveComponent(audioProcessor),
+outputMeterComponent(audioProcessor.outputMeter),
+referenceMatchComponent(audioProcessor.apvts),
 peakFreqKnobAtt(audioProcessor.apvts, "Peak Freq", peakFreqKnob),
 peakGainKnobAtt(audioProcessor.apvts, "Peak Gain", peakGainKnob),
 peakQualityKnobAtt(audioProcessor.apvts, "Peak Quality", peakQualityKnob),
 lowCutFreqKnobAtt(audioProcessor.apvts, "LowCut Freq", lowCutFreqKnob),
 lowCutSlopeKnobAtt(audioProcessor.apvts, "LowCut Slope", lowCutSlopeKnob),
 highCutFreqKnobAtt(audioProcessor.apvts, "HighCut Freq", highCutFreqKnob),
-highCutSlopeKnobAtt(audioProcessor.apvts, "HighCut Slope", highCutSlopeKnob)
+highCutSlopeKnobAtt(audioProcessor.apvts, "HighCut Slope", highCutSlopeKnob),
+analogMatchedButtonAtt(audioProcessor.apvts, "Analog Matched", analogMatchedButton)
 
 
 
@@ -188,7 +346,7 @@ highCutSlopeKnobAtt(audioProcessor.apvts, "HighCut Slope", highCutSlopeKnob)
         addAndMakeVisible(comp);
     }
 
-    setSize (600, 500);
+    setSize (600, 524);
 }
 
 _3BandEqAudioProcessorEditor::~_3BandEqAudioProcessorEditor()
@@ -216,6 +374,14 @@ void _3BandEqAudioProcessorEditor::resized()
 
     freqCurveComponent.setBounds(audioCurveArea);
 
+    // Meter readout under the frequency curve, with the whole width for its text
+    outputMeterComponent.setBounds(bounds.removeFromTop(24));
+
+    // Reference matching and design switch in their own row under the knobs
+    auto optionsArea = bounds.removeFromBottom(24);
+    referenceMatchComponent.setBounds(optionsArea.removeFromLeft(150));
+    analogMatchedButton.setBounds(optionsArea.removeFromRight(130));
+
     auto lowCutArea = bounds.removeFromLeft(bounds.getWidth() * 0.33);
     auto highCutArea = bounds.removeFromRight(bounds.getWidth() * 0.5);
 
@@ -246,6 +412,9 @@ std::vector<juce::Component*> _3BandEqAudioProcessorEditor::getComponents()
         &highCutFreqKnob,
         &lowCutSlopeKnob,
         &highCutSlopeKnob,
-        &freqCurveComponent
+        &freqCurveComponent,
+        &outputMeterComponent,
+        &analogMatchedButton,
+        &referenceMatchComponent
     };
 }
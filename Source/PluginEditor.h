@@ -10,6 +10,7 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "ReferenceMatcher.h"
 
 
 // Custom knob class
@@ -34,12 +35,66 @@ struct FreqCurveComponent : juce::Component,
     void timerCallback() override;
 
     void paint(juce::Graphics& g) override;
+    void resized() override;
 
 private:
     _3BandEqAudioProcessor& audioProcessor;
-    juce::Atomic<bool> parametersChanged{ false };
+
+    // Starts out true so the filters are designed on the first timer tick rather than in the constructor
+    juce::Atomic<bool> parametersChanged{ true };
 
     MonoChain monoChain;
+
+    // Response curve, rebuilt in paint() only after the filters or the size change
+    void updateResponseCurve();
+    juce::Path responseCurve;
+    std::vector<double> magnitudes;
+    bool responseCurveNeedsUpdate{ true };
+};
+
+// Output level readout (click to restart the integrated loudness)
+struct OutputMeterComponent : juce::Component,
+    juce::Timer
+{
+    OutputMeterComponent(OutputMeter&);
+
+    void timerCallback() override;
+
+    void paint(juce::Graphics& g) override;
+    void mouseDown(const juce::MouseEvent& event) override;
+
+private:
+    OutputMeter& outputMeter;
+
+    // Peak falls back slowly so it can be read
+    float displayedPeakDb{ OutputMeter::silenceDb };
+    OutputMeter::Readings readings{ OutputMeter::silenceDb, OutputMeter::silenceDb, OutputMeter::silenceDb, OutputMeter::silenceDb };
+};
+
+// Fits the bands so a track matches a reference mix: pick both files, the analysis runs
+// on a background thread and the result is applied through the parameters
+struct ReferenceMatchComponent : juce::Component,
+    juce::Thread
+{
+    ReferenceMatchComponent(juce::AudioProcessorValueTreeState&);
+    ~ReferenceMatchComponent() override;
+
+    void resized() override;
+    void run() override;
+
+private:
+    void chooseFiles();
+    void applyResult();
+
+    juce::AudioProcessorValueTreeState& apvts;
+
+    juce::TextButton matchButton{ "Match reference..." };
+    std::unique_ptr<juce::FileChooser> sourceChooser, referenceChooser;
+
+    // Set before the thread starts and read again once it has finished
+    juce::File sourceFile, referenceFile;
+    bool analogMatched{ false };
+    ReferenceMatcher::Result result;
 };
 
 //==============================================================================
@@ -63,12 +118,22 @@ private:
     // Declare Frequency Curve Component
     FreqCurveComponent freqCurveComponent;
 
+    // Declare Output Meter Component
+    OutputMeterComponent outputMeterComponent;
+
+    // Bilinear / analog-matched filter design switch
+    juce::ToggleButton analogMatchedButton{ "Analog matched" };
+
+    // Fit the bands to a reference mix
+    ReferenceMatchComponent referenceMatchComponent;
+
     // Alias Attachment
     using APVTS = juce::AudioProcessorValueTreeState;
     using Attachment = APVTS::SliderAttachment;
 
     // Declare Attachments
     Attachment peakFreqKnobAtt, peakGainKnobAtt, peakQualityKnobAtt, lowCutFreqKnobAtt, lowCutSlopeKnobAtt, highCutFreqKnobAtt, highCutSlopeKnobAtt;
+    APVTS::ButtonAttachment analogMatchedButtonAtt;
 
 
 
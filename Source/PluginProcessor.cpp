@@ -8,6 +8,10 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "OfflineRenderer.h"
+#include "StateSpaceCascade.h"
+#include "AutomationTrace.h"
+#include "AudioThreadAudit.h"
 
 //==============================================================================
 _3BandEqAudioProcessor::_3BandEqAudioProcessor()
@@ -108,10 +112,49 @@ void _3BandEqAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     // Sample Rate
     spec.sampleRate = sampleRate;
 
+    // Size the coefficients before prepare() so the filter state is allocated for biquads now
+    prepareCoefficients(leftChain);
+    prepareCoefficients(rightChain);
+
     // Pass spec to each chain
     leftChain.prepare(spec);
     rightChain.prepare(spec);
 
+    // Offline bounces get a thread pool to spread the channels over
+    if (isNonRealtime())
+    {
+        if (offlineRenderer == nullptr)
+            offlineRenderer = std::make_unique<OfflineRenderer>();
+
+        offlineRenderer->prepare(spec);
+    }
+    else
+    {
+        offlineRenderer.reset();
+    }
+
+   #if JUCE_USE_SIMD
+    // A single channel can't be vectorised across channels, so it is vectorised across samples
+    if (getTotalNumOutputChannels() == 1)
+    {
+        if (monoEngine == nullptr)
+            monoEngine = std::make_unique<StateSpaceCascade>();
+
+        monoEngine->reset();
+    }
+    else
+    {
+        monoEngine.reset();
+    }
+   #endif
+
+    // Record this session if EQ_AUTOMATION_TRACE names a folder
+    if (automationRecordingEnabled && automationRecorder == nullptr)
+        automationRecorder = AutomationRecorder::createFromEnvironment(apvts);
+
+    // Meter every output channel the chains process
+    outputMeter.prepare(sampleRate, getTotalNumOutputChannels());
+
     updateFilters();    
 
 }
@@ -120,6 +163,19 @@ void _3BandEqAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+
+    // Report anything the audio thread audit caught while playing
+    auto violations = AudioThreadAudit::getViolations();
+
+    if (violations.heapOperations > 0 || violations.locks > 0)
+        DBG("Audio thread audit: " << violations.heapOperations << " heap operations and "
+                                   << violations.locks << " locks in processBlock");
+}
+
+void _3BandEqAudioProcessor::disableAutomationRecording()
+{
+    automationRecordingEnabled = false;
+    automationRecorder.reset();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -151,6 +207,10 @@ bool _3BandEqAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 void _3BandEqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+
+    // Debug builds can flag any heap use on the real-time thread
+    AudioThreadAudit::ScopedAudioThread auditAudioThread(! isNonRealtime());
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -163,24 +223,52 @@ void _3BandEqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
+    // Note the block before the filters pick up any parameter changes, so a replay updates them the same way
+    if (automationRecorder != nullptr)
+        automationRecorder->recordBlock(buffer.getNumSamples(), totalNumOutputChannels, getSampleRate(), isNonRealtime());
+
     updateFilters();
 
     // Create audio block
     juce::dsp::AudioBlock<float> block(buffer);
 
-    // Represent left and right channels with audio blocks
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
-
-    // Left and Right context
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-
-    // Pass context to left and right filter chains
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
-
+    // Large offline blocks are processed across several threads
+    if (isNonRealtime() && offlineRenderer != nullptr && offlineRenderer->shouldRender(block, { &leftChain, &rightChain }))
+    {
+       #if JUCE_USE_SIMD
+        // A mono bus is segmented on its engine, so the engine's state carries on either way
+        if (monoEngine != nullptr && block.getNumChannels() == 1)
+            offlineRenderer->process(block, *monoEngine, leftChain);
+        else
+       #endif
+            offlineRenderer->process(block, { &leftChain, &rightChain });
+    }
+   #if JUCE_USE_SIMD
+    else if (monoEngine != nullptr && block.getNumChannels() == 1)
+    {
+        // The left chain holds the designed coefficients, the engine keeps its own state
+        monoEngine->setSections(leftChain);
+        monoEngine->process(block.getChannelPointer(0), (int) block.getNumSamples());
+    }
+   #endif
+    else
+    {
+        // Represent left and right channels with audio blocks
+        auto leftBlock = block.getSingleChannelBlock(0);
+        juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
+        leftChain.process(leftContext);
+
+        // A mono bus without the engine only has the left channel
+        if (block.getNumChannels() > 1)
+        {
+            auto rightBlock = block.getSingleChannelBlock(1);
+            juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+            rightChain.process(rightContext);
+        }
+    }
 
+    // Meter the output while the filtered block is still in cache
+    outputMeter.process(block);
 }
 
 //==============================================================================
@@ -220,13 +308,38 @@ ChainParameters getChainParameters(juce::AudioProcessorValueTreeState& apvts)
     parameters.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
     parameters.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
     parameters.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    parameters.analogMatched = apvts.getRawParameterValue("Analog Matched")->load() > 0.5f;
 
     return parameters;
 }
 
-Coefficients createPeakFilter(const ChainParameters& chainParameters, double sampleRate)
+void applyChainParameters(juce::AudioProcessorValueTreeState& apvts, const ChainParameters& chainParameters)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(
+    // Wrap each change in a gesture so hosts record it like an edit
+    auto set = [&apvts](const juce::String& parameterID, float value)
+    {
+        if (auto* parameter = apvts.getParameter(parameterID))
+        {
+            parameter->beginChangeGesture();
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+            parameter->endChangeGesture();
+        }
+    };
+
+    set("LowCut Freq", chainParameters.lowCutFreq);
+    set("HighCut Freq", chainParameters.highCutFreq);
+    set("Peak Freq", chainParameters.peakFreq);
+    set("Peak Gain", chainParameters.peakGain);
+    set("Peak Quality", chainParameters.peakQuality);
+    set("LowCut Slope", (float) chainParameters.lowCutSlope);
+    set("HighCut Slope", (float) chainParameters.highCutSlope);
+}
+
+BiquadCoefficients createPeakFilter(const ChainParameters& chainParameters, double sampleRate)
+{
+    auto design = chainParameters.analogMatched ? designMatchedPeak : designPeak;
+
+    return design(
         sampleRate,
         chainParameters.peakFreq,
         chainParameters.peakQuality,
@@ -243,9 +356,43 @@ void _3BandEqAudioProcessor::updatePeakFilter(const ChainParameters &chainParame
     updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
 }
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements)
+void updateCoefficients(Coefficients& old, const BiquadCoefficients& replacements)
 {
-    *old = *replacements;
+    auto& raw = old->coefficients;
+
+    // A default (first order) filter only gets resized here if prepareCoefficients was skipped
+    if (raw.size() != 5)
+        raw.resize(5);
+
+    auto* c = raw.getRawDataPointer();
+    c[0] = replacements.b0;
+    c[1] = replacements.b1;
+    c[2] = replacements.b2;
+    c[3] = replacements.a1;
+    c[4] = replacements.a2;
+}
+
+void prepareCoefficients(MonoChain& chain)
+{
+    // Start undesigned filters as pass-through biquads, keep existing designs as they are
+    auto prepare = [](Coefficients& coefficients)
+    {
+        if (coefficients->coefficients.size() != 5)
+            updateCoefficients(coefficients, {});
+    };
+
+    auto& lowCut = chain.get<ChainPositions::LowCut>();
+    auto& highCut = chain.get<ChainPositions::HighCut>();
+
+    prepare(lowCut.get<0>().coefficients);
+    prepare(lowCut.get<1>().coefficients);
+    prepare(lowCut.get<2>().coefficients);
+    prepare(lowCut.get<3>().coefficients);
+    prepare(chain.get<ChainPositions::Peak>().coefficients);
+    prepare(highCut.get<0>().coefficients);
+    prepare(highCut.get<1>().coefficients);
+    prepare(highCut.get<2>().coefficients);
+    prepare(highCut.get<3>().coefficients);
 }
 
 void _3BandEqAudioProcessor::updateLowCutFilter(const ChainParameters& chainParameters)
@@ -277,10 +424,38 @@ void _3BandEqAudioProcessor::updateHighCutFilter(const ChainParameters& chainPar
 void _3BandEqAudioProcessor::updateFilters()
 {
     auto chainParameters = getChainParameters(apvts);
+    auto sampleRate = getSampleRate();
+
+    // Only redesign the bands whose settings changed since they were last designed
+    // (a new sample rate or design mode changes all of them)
+    auto redesignAll = sampleRate != designedSampleRate
+                          || chainParameters.analogMatched != designedParameters.analogMatched;
+    auto& designed = designedParameters;
+
+    if (redesignAll
+        || chainParameters.lowCutFreq != designed.lowCutFreq
+        || chainParameters.lowCutSlope != designed.lowCutSlope)
+    {
+        updateLowCutFilter(chainParameters);
+    }
+
+    if (redesignAll
+        || chainParameters.peakFreq != designed.peakFreq
+        || chainParameters.peakGain != designed.peakGain
+        || chainParameters.peakQuality != designed.peakQuality)
+    {
+        updatePeakFilter(chainParameters);
+    }
+
+    if (redesignAll
+        || chainParameters.highCutFreq != designed.highCutFreq
+        || chainParameters.highCutSlope != designed.highCutSlope)
+    {
+        updateHighCutFilter(chainParameters);
+    }
 
-    updateLowCutFilter(chainParameters);
-    updatePeakFilter(chainParameters);
-    updateHighCutFilter(chainParameters);
+    designedParameters = chainParameters;
+    designedSampleRate = sampleRate;
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout _3BandEqAudioProcessor::createParameterLayout()
@@ -321,19 +496,16 @@ juce::AudioProcessorValueTreeState::ParameterLayout _3BandEqAudioProcessor::crea
                                                            juce::NormalisableRange<float>(0.1f, 10.0f, 0.05f, 1.f, false),
                                                            1.f));
 
-    // String Array that holds db/Oct Values
-    juce::StringArray db_per_octave;
-    for ( int i = 0; i < 4; ++i ) {
-        juce::String str;
-        str << (12 + 12*i);
-        str << " db/Oct";
-        db_per_octave.add(str);
-    }
+    // String Array that holds db/Oct Values (built once and shared by every instance)
+    static const juce::StringArray db_per_octave { "12 db/Oct", "24 db/Oct", "36 db/Oct", "48 db/Oct" };
 
     // Low Cut and High Cut Steepness (12, 24, 36, 48 db/Oct)
     layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", db_per_octave, 0));
     layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", db_per_octave, 0));
 
+    // Filter design (Off = bilinear, On = analog-matched, accurate up to Nyquist)
+    layout.add(std::make_unique<juce::AudioParameterBool>("Analog Matched", "Analog Matched", false));
+
     return layout;
 }
 
@@ -9,6 +9,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "FilterDesigner.h"
+#include "OutputMeter.h"
 
 enum Slope
 {
@@ -24,11 +26,17 @@ struct ChainParameters
     float peakFreq{ 0 }, peakGain{ 0 }, peakQuality{ 1.f };
     float lowCutFreq{ 0 }, highCutFreq{ 0 };
     Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
+
+    // Use the analog-matched designs instead of the bilinear ones
+    bool analogMatched{ false };
 };
 
 // Get parameter values
 ChainParameters getChainParameters(juce::AudioProcessorValueTreeState& apvts);
 
+// Set parameter values through the host, as if the knobs were moved (everything but the design mode)
+void applyChainParameters(juce::AudioProcessorValueTreeState& apvts, const ChainParameters& chainParameters);
+
 // Peak Filter
 using Filter = juce::dsp::IIR::Filter<float>;
 
@@ -47,10 +55,15 @@ enum ChainPositions
 };
 
 using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+
+// Overwrite coefficients in place (no allocation once prepareCoefficients has run)
+void updateCoefficients(Coefficients& old, const BiquadCoefficients& replacements);
+
+// Size every filter in the chain for a biquad up front, so the audio thread never has to
+void prepareCoefficients(MonoChain& chain);
 
 // Create Peak Filter
-Coefficients createPeakFilter(const ChainParameters& chainParameters, double sampleRate);
+BiquadCoefficients createPeakFilter(const ChainParameters& chainParameters, double sampleRate);
 
 template<int Idx, typename ChainType, typename CoefficientType>
 void update(ChainType& chain, const CoefficientType& lowCutCoefficients)
@@ -94,23 +107,27 @@ void updateCutFilter(ChainType& chain, const CoefficientType& coefficients, cons
     }
 }
 
-// Create Low Cut Filter
-inline auto createLowCutFilter(const ChainParameters& chainParameters, double sampleRate)
+// Create Low Cut Filter (one section per 12 db/Oct)
+inline CutCoefficients createLowCutFilter(const ChainParameters& chainParameters, double sampleRate)
 {
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(
-        chainParameters.lowCutFreq,
+    auto design = chainParameters.analogMatched ? designMatchedButterworthHighPass : designButterworthHighPass;
+
+    return design(
         sampleRate,
-        (chainParameters.lowCutSlope + 1) * 2
+        chainParameters.lowCutFreq,
+        chainParameters.lowCutSlope + 1
     );
 }
 
-// Create High Cut Filter
-inline auto createHighCutFilter(const ChainParameters& chainParameters, double sampleRate)
+// Create High Cut Filter (one section per 12 db/Oct)
+inline CutCoefficients createHighCutFilter(const ChainParameters& chainParameters, double sampleRate)
 {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(
-        chainParameters.highCutFreq,
+    auto design = chainParameters.analogMatched ? designMatchedButterworthLowPass : designButterworthLowPass;
+
+    return design(
         sampleRate,
-        (chainParameters.highCutSlope + 1) * 2
+        chainParameters.highCutFreq,
+        chainParameters.highCutSlope + 1
     );
 }
 
@@ -121,6 +138,10 @@ inline auto createHighCutFilter(const ChainParameters& chainParameters, double s
 
 
 
+class OfflineRenderer;
+class StateSpaceCascade;
+class AutomationRecorder;
+
 //==============================================================================
 /**
 */
@@ -168,11 +189,30 @@ public:
         createParameterLayout();
     juce::AudioProcessorValueTreeState apvts{ *this, nullptr, "Parameters", createParameterLayout()};
 
+    // Output levels, measured on the audio thread and read by the editor
+    OutputMeter outputMeter;
+
+    // Keep this instance out of EQ_AUTOMATION_TRACE recording, e.g. while it replays a trace.
+    // Call it before prepareToPlay.
+    void disableAutomationRecording();
+
 private:
 
     // Create a left and right MonoChain instance to do Stereo Processing
     MonoChain leftChain, rightChain;
 
+    // Spreads offline bounces across threads (only created when the host renders non-realtime)
+    std::unique_ptr<OfflineRenderer> offlineRenderer;
+
+   #if JUCE_USE_SIMD
+    // Runs the left chain's filters several samples at a time on a mono bus (only created then)
+    std::unique_ptr<StateSpaceCascade> monoEngine;
+   #endif
+
+    // Writes a trace of blocks and parameter changes for the replay benchmark (only when asked for)
+    std::unique_ptr<AutomationRecorder> automationRecorder;
+    bool automationRecordingEnabled = true;
+
     void updatePeakFilter(const ChainParameters& chainParameters);
 
     
@@ -183,6 +223,10 @@ private:
 
     void updateFilters();
 
+    // What the chains were last designed for, so unchanged bands aren't redesigned
+    ChainParameters designedParameters;
+    double designedSampleRate = 0;
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (_3BandEqAudioProcessor)
 };
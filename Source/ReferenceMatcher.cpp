@@ -0,0 +1,636 @@
+/*
+  ==============================================================================
+
+    ReferenceMatcher.cpp
+
+    Fits the EQ's bands so a track's long-term spectrum matches a reference mix.
+
+  ==============================================================================
+*/
+
+#include "ReferenceMatcher.h"
+
+namespace
+{
+   #if JUCE_USE_SIMD
+    using Register = juce::dsp::SIMDRegister<double>;
+    constexpr auto pointsPerRegister = Register::SIMDNumElements;
+   #endif
+
+    // Fit points every 1/12 octave, each the mean over the 1/12 octave around it. Wider smoothing
+    // blurs the cut slopes enough to bias the fitted frequencies and slopes.
+    constexpr double minFitFrequency = 20.0;
+    constexpr double maxFitFrequency = 20000.0;
+    constexpr double pointsPerOctave = 12.0;
+    constexpr double smoothingOctaves = 1.0 / 12.0;
+
+    // Bands this far below a file's loudest one count as empty. Differences are clamped to what
+    // the EQ can sensibly reach, so a reference with nothing below 30 Hz asks for a cut, not -90 dB.
+    constexpr double dynamicRangeDb = 60.0;
+    constexpr double floorDb = -48.0;
+    constexpr double ceilingDb = 24.0;
+
+    // The bins whose centres lie in a frequency range (at least the one nearest its middle)
+    juce::Range<int> getBins(const LongTermSpectrum& spectrum, double lowFrequency, double highFrequency)
+    {
+        const auto binWidth = spectrum.sampleRate / spectrum.fftSize;
+        const auto lastBin = (int) spectrum.power.size() - 1;
+
+        auto first = juce::jmax(1, (int) std::ceil(lowFrequency / binWidth));
+        auto last = juce::jmin(lastBin, (int) std::floor(highFrequency / binWidth));
+
+        if (last < first)
+            first = last = juce::jlimit(1, lastBin, juce::roundToInt(0.5 * (lowFrequency + highFrequency) / binWidth));
+
+        return { first, last + 1 };
+    }
+
+    double getMeanPower(const LongTermSpectrum& spectrum, juce::Range<int> bins)
+    {
+        auto sum = 0.0;
+
+        for (auto bin = bins.getStart(); bin < bins.getEnd(); ++bin)
+            sum += spectrum.power[(size_t) bin];
+
+        return sum / bins.getLength();
+    }
+
+    double powerToDecibels(double power)
+    {
+        return 10.0 * std::log10(juce::jmax(power, 1.0e-30));
+    }
+
+    // |H|^2 of a biquad as polynomials in phi = sin^2(w / 2), which stay accurate near DC:
+    // (b0 + b1 + b2)^2 - 4 (b0 b1 + b1 b2 + 4 b0 b2) phi + 16 b0 b2 phi^2, and the same for (1, a1, a2)
+    struct PowerPolynomials
+    {
+        explicit PowerPolynomials(const BiquadCoefficients& c)
+        {
+            const double b0 = c.b0, b1 = c.b1, b2 = c.b2, a1 = c.a1, a2 = c.a2;
+
+            numerator = { juce::square(b0 + b1 + b2), -4.0 * (b0 * b1 + b1 * b2 + 4.0 * b0 * b2), 16.0 * b0 * b2 };
+            denominator = { juce::square(1.0 + a1 + a2), -4.0 * (a1 + a1 * a2 + 4.0 * a2), 16.0 * a2 };
+        }
+
+        std::array<double, 3> numerator, denominator;
+    };
+
+    // Low cut, high cut and peak frequency and the peak's Q are searched in octaves, the gain in dB
+    using SearchPoint = std::array<double, 5>;
+
+    // The target curve and the candidate responses, evaluated a SIMD register of points at a time
+    // where juce_dsp has SIMD support, and one point at a time otherwise. Both run the same
+    // double-precision operations on each point, so they give the same fit.
+    class ResponseFitter
+    {
+    public:
+        ResponseFitter(const LongTermSpectrum& source, const LongTermSpectrum& reference, bool analogMatched, bool useSimd)
+            : sampleRate(source.sampleRate), analogMatched(analogMatched)
+           #if JUCE_USE_SIMD
+            , useSimd(useSimd)
+           #endif
+        {
+            juce::ignoreUnused(useSimd);
+
+            const auto nyquistLimit = 0.45 * juce::jmin(source.sampleRate, reference.sampleRate);
+            const auto maxFrequency = juce::jmin(maxFitFrequency, nyquistLimit);
+
+            // Band levels of both files. Each point sits at the centre of the source bins it averages,
+            // so the responses are compared where the spectra were measured (this matters on the
+            // steep slopes at the low end, where the bands are only a bin or two wide).
+            const auto halfWidth = std::exp2(smoothingOctaves * 0.5);
+            const auto binWidth = source.sampleRate / source.fftSize;
+            std::vector<double> sourceDb, referenceDb;
+            juce::Range<int> previousBins;
+
+            for (auto f = minFitFrequency; f <= maxFrequency; f *= std::exp2(1.0 / pointsPerOctave))
+            {
+                auto bins = getBins(source, f / halfWidth, f * halfWidth);
+
+                if (bins == previousBins)
+                    continue;
+
+                previousBins = bins;
+
+                auto lowFrequency = (bins.getStart() - 0.5) * binWidth;
+                auto highFrequency = (bins.getEnd() - 0.5) * binWidth;
+
+                frequencies.push_back(0.5 * (lowFrequency + highFrequency));
+                sourceDb.push_back(powerToDecibels(getMeanPower(source, bins)));
+                referenceDb.push_back(powerToDecibels(getMeanPower(reference, getBins(reference, lowFrequency, highFrequency))));
+            }
+
+            if (frequencies.empty())
+                return;
+
+            // Levels are judged relative to each file's loudest band
+            const auto sourceFloor = *std::max_element(sourceDb.begin(), sourceDb.end()) - dynamicRangeDb;
+            const auto referenceFloor = *std::max_element(referenceDb.begin(), referenceDb.end()) - dynamicRangeDb;
+
+            // Only fit where the source has something to shape. Where the reference is empty the
+            // target is only an upper bound: any response below it fits.
+            targetDb.resize(frequencies.size());
+            weights.resize(frequencies.size());
+            isUpperBound.resize(frequencies.size());
+
+            for (size_t i = 0; i < frequencies.size(); ++i)
+            {
+                isUpperBound[i] = referenceDb[i] <= referenceFloor;
+                targetDb[i] = juce::jmax(referenceDb[i], referenceFloor) - sourceDb[i];
+                weights[i] = sourceDb[i] > sourceFloor ? 1.0 : 0.0;
+            }
+
+            // Line the curves up on the midrange, so the clamps below sit at sensible levels
+            auto offset = 0.0, offsetWeight = 0.0;
+
+            for (size_t i = 0; i < frequencies.size(); ++i)
+            {
+                if (frequencies[i] >= 200.0 && frequencies[i] <= 2000.0)
+                {
+                    offset += weights[i] * targetDb[i];
+                    offsetWeight += weights[i];
+                }
+            }
+
+            if (offsetWeight > 0)
+                offset /= offsetWeight;
+
+            for (auto& target : targetDb)
+                target = juce::jlimit(floorDb, ceilingDb, target - offset);
+
+            totalWeight = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+            // sin^2(w / 2) for every point
+            for (auto f : frequencies)
+                phi.push_back(juce::square(std::sin(juce::MathConstants<double>::pi * f / sampleRate)));
+
+            numerators.resize(phi.size());
+            denominators.resize(phi.size());
+
+           #if JUCE_USE_SIMD
+            // The same, padded to whole registers
+            const auto numRegisters = (phi.size() + pointsPerRegister - 1) / pointsPerRegister;
+            phiLanes.resize(numRegisters);
+            numeratorLanes.resize(numRegisters);
+            denominatorLanes.resize(numRegisters);
+
+            for (size_t r = 0; r < numRegisters; ++r)
+                for (size_t lane = 0; lane < pointsPerRegister; ++lane)
+                    phiLanes[r].set(lane, phi[juce::jmin(r * pointsPerRegister + lane, phi.size() - 1)]);
+           #endif
+
+            responseDb.resize(frequencies.size());
+        }
+
+        bool hasPoints() const { return totalWeight > 0; }
+
+        ChainParameters toParameters(const SearchPoint& x, Slope lowCutSlope, Slope highCutSlope) const
+        {
+            ChainParameters parameters;
+            parameters.lowCutFreq = (float) std::exp2(x[0]);
+            parameters.highCutFreq = (float) std::exp2(x[1]);
+            parameters.peakFreq = (float) std::exp2(x[2]);
+            parameters.peakGain = (float) x[3];
+            parameters.peakQuality = (float) std::exp2(x[4]);
+            parameters.lowCutSlope = lowCutSlope;
+            parameters.highCutSlope = highCutSlope;
+            parameters.analogMatched = analogMatched;
+
+            return parameters;
+        }
+
+        double getMaxFrequency() const { return juce::jmin(maxFitFrequency, 0.49 * sampleRate); }
+
+        // Weighted mean squared difference from the target, in dB^2
+        double getError(const ChainParameters& parameters)
+        {
+            computeResponse(parameters);
+
+            auto sum = 0.0;
+
+            for (size_t i = 0; i < responseDb.size(); ++i)
+                sum += weights[i] * juce::square(getResidual(i));
+
+            return sum / totalWeight;
+        }
+
+        // Where the current response is furthest from the target (for placing the peak)
+        size_t getLargestResidual(const ChainParameters& parameters, double minFrequency, double maxFrequency)
+        {
+            computeResponse(parameters);
+
+            size_t largest = 0;
+            auto largestResidual = -1.0;
+
+            for (size_t i = 0; i < responseDb.size(); ++i)
+            {
+                auto residual = std::abs(getResidual(i)) * weights[i];
+
+                if (frequencies[i] >= minFrequency && frequencies[i] <= maxFrequency && residual > largestResidual)
+                {
+                    largest = i;
+                    largestResidual = residual;
+                }
+            }
+
+            return largest;
+        }
+
+        double getFrequency(size_t point) const { return frequencies[point]; }
+        double getTargetDb(size_t point) const { return targetDb[point]; }
+        double getResponseDb(size_t point) const { return responseDb[point]; }
+
+    private:
+        double getResidual(size_t point) const
+        {
+            auto residual = responseDb[point] - targetDb[point];
+            return isUpperBound[point] ? juce::jmax(0.0, residual) : residual;
+        }
+
+        // Response in dB at every point. The EQ has no output gain, so the curves are only
+        // compared up to overall level: the response is shifted to the target's mean.
+        void computeResponse(const ChainParameters& parameters)
+        {
+            std::fill(numerators.begin(), numerators.end(), 1.0);
+            std::fill(denominators.begin(), denominators.end(), 1.0);
+
+           #if JUCE_USE_SIMD
+            std::fill(numeratorLanes.begin(), numeratorLanes.end(), Register::expand(1.0));
+            std::fill(denominatorLanes.begin(), denominatorLanes.end(), Register::expand(1.0));
+           #endif
+
+            auto lowCut = createLowCutFilter(parameters, sampleRate);
+            auto highCut = createHighCutFilter(parameters, sampleRate);
+
+            for (int i = 0; i <= parameters.lowCutSlope; ++i)
+                multiplyBy(lowCut[(size_t) i]);
+
+            multiplyBy(createPeakFilter(parameters, sampleRate));
+
+            for (int i = 0; i <= parameters.highCutSlope; ++i)
+                multiplyBy(highCut[(size_t) i]);
+
+           #if JUCE_USE_SIMD
+            if (useSimd)
+            {
+                for (size_t i = 0; i < responseDb.size(); ++i)
+                {
+                    numerators[i] = numeratorLanes[i / pointsPerRegister].get(i % pointsPerRegister);
+                    denominators[i] = denominatorLanes[i / pointsPerRegister].get(i % pointsPerRegister);
+                }
+            }
+           #endif
+
+            for (size_t i = 0; i < responseDb.size(); ++i)
+                responseDb[i] = powerToDecibels(numerators[i] / juce::jmax(denominators[i], 1.0e-300));
+
+            // Shift the response onto the target where the target isn't clamped, then clamp it the same way
+            auto shift = 0.0, shiftWeight = 0.0;
+
+            for (size_t i = 0; i < responseDb.size(); ++i)
+            {
+                if (targetDb[i] > floorDb && targetDb[i] < ceilingDb && ! isUpperBound[i])
+                {
+                    shift += weights[i] * (targetDb[i] - responseDb[i]);
+                    shiftWeight += weights[i];
+                }
+            }
+
+            if (shiftWeight > 0)
+                shift /= shiftWeight;
+
+            for (auto& response : responseDb)
+                response = juce::jlimit(floorDb, ceilingDb, response + shift);
+        }
+
+        void multiplyBy(const BiquadCoefficients& coefficients)
+        {
+            const PowerPolynomials section(coefficients);
+            const auto& n = section.numerator;
+            const auto& d = section.denominator;
+
+           #if JUCE_USE_SIMD
+            if (useSimd)
+            {
+                for (size_t r = 0; r < phiLanes.size(); ++r)
+                {
+                    const auto x = phiLanes[r];
+                    numeratorLanes[r] = numeratorLanes[r] * ((x * n[2] + n[1]) * x + n[0]);
+                    denominatorLanes[r] = denominatorLanes[r] * ((x * d[2] + d[1]) * x + d[0]);
+                }
+
+                return;
+            }
+           #endif
+
+            for (size_t i = 0; i < phi.size(); ++i)
+            {
+                const auto x = phi[i];
+                numerators[i] = numerators[i] * ((x * n[2] + n[1]) * x + n[0]);
+                denominators[i] = denominators[i] * ((x * d[2] + d[1]) * x + d[0]);
+            }
+        }
+
+        const double sampleRate;
+        const bool analogMatched;
+
+        std::vector<double> frequencies, targetDb, weights, responseDb;
+        std::vector<bool> isUpperBound;
+        double totalWeight = 0;
+
+        // |H|^2 at each point, built up a section at a time
+        std::vector<double> phi, numerators, denominators;
+
+       #if JUCE_USE_SIMD
+        const bool useSimd;
+        std::vector<Register> phiLanes, numeratorLanes, denominatorLanes;
+       #endif
+    };
+
+    // The steps createParameterLayout gives each parameter, so the reported fit is the one the
+    // parameters can actually hold
+    ChainParameters snapToParameterSteps(ChainParameters parameters)
+    {
+        auto snap = [](float value, float start, float end, float interval)
+        {
+            return juce::jlimit(start, end, start + interval * std::round((value - start) / interval));
+        };
+
+        parameters.lowCutFreq = snap(parameters.lowCutFreq, 20.f, 20000.f, 1.f);
+        parameters.highCutFreq = snap(parameters.highCutFreq, 20.f, 20000.f, 1.f);
+        parameters.peakFreq = snap(parameters.peakFreq, 20.f, 20000.f, 1.f);
+        parameters.peakGain = snap(parameters.peakGain, -24.f, 24.f, 0.5f);
+        parameters.peakQuality = snap(parameters.peakQuality, 0.1f, 10.f, 0.05f);
+
+        return parameters;
+    }
+
+    // Pattern search: step each coordinate both ways, keep any improvement, halve the steps when
+    // nothing improves. Cheap per evaluation and robust on this small, smooth problem.
+    double search(ResponseFitter& fitter, SearchPoint& x, const std::array<bool, 5>& free,
+                  Slope lowCutSlope, Slope highCutSlope)
+    {
+        const auto maxOctave = std::log2(fitter.getMaxFrequency());
+        const SearchPoint lower{ std::log2(20.0), std::log2(20.0), std::log2(20.0), -24.0, std::log2(0.1) };
+        const SearchPoint upper{ maxOctave, maxOctave, maxOctave, 24.0, std::log2(10.0) };
+        const SearchPoint minSteps{ 1.0 / 48.0, 1.0 / 48.0, 1.0 / 48.0, 0.1, 1.0 / 48.0 };
+        SearchPoint steps{ 1.0, 1.0, 1.0, 3.0, 1.0 };
+
+        constexpr int maxEvaluations = 1000;
+
+        auto error = fitter.getError(fitter.toParameters(x, lowCutSlope, highCutSlope));
+
+        for (int evaluations = 1; evaluations < maxEvaluations;)
+        {
+            auto improved = false;
+            auto searching = false;
+
+            for (size_t d = 0; d < x.size(); ++d)
+            {
+                if (! free[d] || steps[d] < minSteps[d])
+                    continue;
+
+                searching = true;
+
+                for (auto direction : { 1.0, -1.0 })
+                {
+                    auto candidate = x;
+                    candidate[d] = juce::jlimit(lower[d], upper[d], x[d] + direction * steps[d]);
+
+                    if (candidate[d] == x[d])
+                        continue;
+
+                    auto candidateError = fitter.getError(fitter.toParameters(candidate, lowCutSlope, highCutSlope));
+                    ++evaluations;
+
+                    if (candidateError < error)
+                    {
+                        x = candidate;
+                        error = candidateError;
+                        improved = true;
+                        break;
+                    }
+                }
+            }
+
+            if (! searching)
+                break;
+
+            if (! improved)
+                for (auto& step : steps)
+                    step *= 0.5;
+        }
+
+        return error;
+    }
+}
+
+ReferenceMatcher::ReferenceMatcher()
+{
+    formatManager.registerBasicFormats();
+}
+
+ReferenceMatcher::Result ReferenceMatcher::match(const juce::File& source, const juce::File& reference, bool analogMatched,
+                                                 const CancelCallback& shouldCancel)
+{
+    Result result;
+
+    auto isCancelled = [&]
+    {
+        if (shouldCancel == nullptr || ! shouldCancel())
+            return false;
+
+        result.errorMessage = "Cancelled";
+        return true;
+    };
+
+    auto sourceSpectrum = analyse(source, shouldCancel);
+
+    if (isCancelled())
+        return result;
+
+    if (sourceSpectrum.numFrames == 0)
+    {
+        result.errorMessage = "Couldn't read " + source.getFileName();
+        return result;
+    }
+
+    auto referenceSpectrum = analyse(reference, shouldCancel);
+
+    if (isCancelled())
+        return result;
+
+    if (referenceSpectrum.numFrames == 0)
+    {
+        result.errorMessage = "Couldn't read " + reference.getFileName();
+        return result;
+    }
+
+    result.parameters = fit(sourceSpectrum, referenceSpectrum, analogMatched, &result.rmsErrorDb);
+    result.succeeded = true;
+
+    return result;
+}
+
+LongTermSpectrum ReferenceMatcher::analyse(const juce::File& file, const CancelCallback& shouldCancel)
+{
+    LongTermSpectrum spectrum;
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0 || reader->numChannels == 0)
+        return spectrum;
+
+    // Frames start every hop, the last one is zero-padded past the end of the file
+    const auto totalFrames = 1 + juce::jmax((juce::int64) 0, reader->lengthInSamples - fftSize + hopSize - 1) / hopSize;
+    const auto numTasks = (int) ((totalFrames + framesPerTask - 1) / framesPerTask);
+
+    std::vector<TaskResult> results((size_t) numTasks);
+
+    // runParallel waits for every task, so none outlives results
+    threads->runParallel(numTasks, [this, &file, &shouldCancel, &results, totalFrames](int task)
+    {
+        const auto firstFrame = (juce::int64) task * framesPerTask;
+        runTask(file, firstFrame, juce::jmin(totalFrames, firstFrame + framesPerTask), shouldCancel, results[(size_t) task]);
+    });
+
+    spectrum.sampleRate = reader->sampleRate;
+    spectrum.fftSize = fftSize;
+    spectrum.power.assign((size_t) fftSize / 2 + 1, 0.0);
+
+    for (auto& result : results)
+    {
+        if (result.failed)
+            return {};
+
+        for (size_t bin = 0; bin < spectrum.power.size(); ++bin)
+            spectrum.power[bin] += result.power[bin];
+
+        spectrum.numFrames += result.numFrames;
+    }
+
+    for (auto& power : spectrum.power)
+        power /= (double) spectrum.numFrames;
+
+    return spectrum;
+}
+
+void ReferenceMatcher::runTask(const juce::File& file, juce::int64 firstFrame, juce::int64 lastFrame,
+                               const CancelCallback& shouldCancel, TaskResult& result)
+{
+    // A cancelled task counts as failed, which makes analyse() give up on the file
+    auto isCancelled = [&] { return shouldCancel != nullptr && shouldCancel(); };
+
+    if (isCancelled())
+    {
+        result.failed = true;
+        return;
+    }
+
+    // Readers aren't thread safe, so every task streams its frames through its own
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr)
+    {
+        result.failed = true;
+        return;
+    }
+
+    const auto numChannels = (int) reader->numChannels;
+
+    juce::dsp::FFT fft(fftOrder);
+    juce::dsp::WindowingFunction<float> window((size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false);
+
+    // A run of overlapping frames is read at once, then windowed and transformed in place
+    juce::AudioBuffer<float> buffer(numChannels, fftSize + (framesPerRead - 1) * hopSize);
+    std::vector<float> fftData((size_t) fftSize * 2);
+
+    result.power.assign((size_t) fftSize / 2 + 1, 0.0);
+
+    for (auto frame = firstFrame; frame < lastFrame; frame += framesPerRead)
+    {
+        if (isCancelled())
+        {
+            result.failed = true;
+            return;
+        }
+
+        const auto numFrames = (int) juce::jmin((juce::int64) framesPerRead, lastFrame - frame);
+
+        // Samples past the end of the file come back as silence
+        reader->read(&buffer, 0, fftSize + (numFrames - 1) * hopSize, frame * hopSize, true, true);
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* start = buffer.getReadPointer(channel, i * hopSize);
+                std::copy(start, start + fftSize, fftData.begin());
+
+                window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+                fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+                for (size_t bin = 0; bin < result.power.size(); ++bin)
+                    result.power[bin] += (double) fftData[bin] * fftData[bin];
+            }
+        }
+
+        result.numFrames += numFrames;
+    }
+}
+
+ChainParameters ReferenceMatcher::fit(const LongTermSpectrum& source, const LongTermSpectrum& reference,
+                                      bool analogMatched, float* rmsErrorDb, bool useSimd)
+{
+    ChainParameters best;
+    best.lowCutFreq = 20.f;
+    best.highCutFreq = 20000.f;
+    best.peakFreq = 1000.f;
+    best.analogMatched = analogMatched;
+
+    if (source.numFrames == 0 || reference.numFrames == 0)
+        return best;
+
+    ResponseFitter fitter(source, reference, analogMatched, useSimd);
+
+    if (! fitter.hasPoints())
+        return best;
+
+    best.highCutFreq = (float) fitter.getMaxFrequency();
+    best = snapToParameterSteps(best);
+
+    auto bestError = fitter.getError(best);
+
+    // The slopes are discrete, so each pair gets its own search
+    for (auto lowCutSlope : { Slope_12, Slope_24, Slope_36, Slope_48 })
+    {
+        for (auto highCutSlope : { Slope_12, Slope_24, Slope_36, Slope_48 })
+        {
+            // Fit the cuts first, with the bands wide open and the peak flat...
+            SearchPoint x{ std::log2(20.0), std::log2(fitter.getMaxFrequency()), std::log2(1000.0), 0.0, 0.0 };
+            search(fitter, x, { true, true, false, false, false }, lowCutSlope, highCutSlope);
+
+            // ... then start the peak where the cuts leave the most to do, and refine everything
+            auto point = fitter.getLargestResidual(fitter.toParameters(x, lowCutSlope, highCutSlope), 30.0, 16000.0);
+            x[2] = std::log2(fitter.getFrequency(point));
+            x[3] = juce::jlimit(-24.0, 24.0, fitter.getTargetDb(point) - fitter.getResponseDb(point));
+
+            search(fitter, x, { true, true, true, true, true }, lowCutSlope, highCutSlope);
+
+            // Pairs are compared on the settings that will actually be applied
+            auto candidate = snapToParameterSteps(fitter.toParameters(x, lowCutSlope, highCutSlope));
+            auto error = fitter.getError(candidate);
+
+            if (error < bestError)
+            {
+                bestError = error;
+                best = candidate;
+            }
+        }
+    }
+
+    if (rmsErrorDb != nullptr)
+        *rmsErrorDb = (float) std::sqrt(bestError);
+
+    return best;
+}
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    ReferenceMatcher.h
+
+    Fits the EQ's bands so a track's long-term spectrum matches a reference mix.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "SharedThreadPool.h"
+
+// Average power spectrum of a whole file (all channels summed)
+struct LongTermSpectrum
+{
+    double sampleRate = 0;
+    int fftSize = 0;
+
+    // Mean power of bins 0 .. fftSize / 2
+    std::vector<double> power;
+    juce::int64 numFrames = 0;
+};
+
+// Offline analysis for the "Match reference" feature.
+// Both files are read in streamed chunks spread over the shared thread pool, then the bands are
+// fitted to the smoothed difference between the spectra. Runs synchronously: call it off the
+// message thread. A shouldCancel callback is polled by every task before each read, so a
+// cancelled analysis returns within one read, after all of its tasks have.
+class ReferenceMatcher
+{
+public:
+    ReferenceMatcher();
+
+    struct Result
+    {
+        bool succeeded = false;
+        juce::String errorMessage;
+
+        ChainParameters parameters;
+
+        // How far the fitted response is from the spectral difference (RMS over the fitted range)
+        float rmsErrorDb = 0;
+    };
+
+    using CancelCallback = std::function<bool()>;
+
+    // Analyse both files and fit every band except the design mode, which is taken as given
+    Result match(const juce::File& source, const juce::File& reference, bool analogMatched,
+                 const CancelCallback& shouldCancel = nullptr);
+
+    // Long-term spectrum of one file (numFrames is 0 if it can't be read or was cancelled)
+    LongTermSpectrum analyse(const juce::File& file, const CancelCallback& shouldCancel = nullptr);
+
+    // Band settings whose response best follows reference - source, ignoring overall level.
+    // They come snapped to the parameters' steps, and the error is the one those settings give.
+    // useSimd = false evaluates the responses with the scalar loop builds without SIMD use.
+    static ChainParameters fit(const LongTermSpectrum& source, const LongTermSpectrum& reference,
+                               bool analogMatched, float* rmsErrorDb = nullptr, bool useSimd = true);
+
+private:
+    // What one task adds up over its run of frames
+    struct TaskResult
+    {
+        std::vector<double> power;
+        juce::int64 numFrames = 0;
+        bool failed = false;
+    };
+
+    void runTask(const juce::File& file, juce::int64 firstFrame, juce::int64 lastFrame,
+                 const CancelCallback& shouldCancel, TaskResult& result);
+
+    // 8192 points: under 6 Hz per bin at 48 kHz, fine enough for the 20 Hz end of the fit
+    static constexpr int fftOrder = 13;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 2;
+
+    // Frames per task, and per read within a task
+    static constexpr int framesPerTask = 256;
+    static constexpr int framesPerRead = 32;
+
+    juce::AudioFormatManager formatManager;
+    juce::SharedResourcePointer<SharedThreadPool> threads;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ReferenceMatcher)
+};
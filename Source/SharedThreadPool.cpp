@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    SharedThreadPool.cpp
+
+    One set of worker threads for every instance in the process.
+
+  ==============================================================================
+*/
+
+#include "SharedThreadPool.h"
+
+namespace
+{
+    // Lives as long as the last job holding it, since a queued job may only start after
+    // the caller has finished every task and returned
+    struct Batch
+    {
+        const std::function<void(int)>* task = nullptr;
+        int numTasks = 0;
+
+        std::atomic<int> nextTask{ 0 };
+        std::atomic<int> numFinished{ 0 };
+        juce::WaitableEvent allFinished;
+
+        void drain()
+        {
+            // Every thread pulls the next unclaimed task until none are left
+            for (auto i = nextTask++; i < numTasks; i = nextTask++)
+            {
+                (*task)(i);
+
+                if (++numFinished == numTasks)
+                    allFinished.signal();
+            }
+        }
+    };
+}
+
+SharedThreadPool::SharedThreadPool()
+    : pool(juce::jmax(1, juce::SystemStats::getNumCpus() - 1))
+{
+}
+
+void SharedThreadPool::runParallel(int numTasks, const std::function<void(int)>& task)
+{
+    if (numTasks <= 0)
+        return;
+
+    auto batch = std::make_shared<Batch>();
+    batch->task = &task;
+    batch->numTasks = numTasks;
+
+    // The calling thread works too, so it only needs help with the remaining tasks
+    auto numHelpers = juce::jmin(pool.getNumThreads(), numTasks - 1);
+
+    for (int i = 0; i < numHelpers; ++i)
+        pool.addJob([batch] { batch->drain(); });
+
+    batch->drain();
+    batch->allFinished.wait();
+}
@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    SharedThreadPool.h
+
+    One set of worker threads for every instance in the process.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Worker threads shared by all instances (hold one through a juce::SharedResourcePointer).
+// A session bouncing a hundred tracks at once then runs on one pool sized to the machine,
+// rather than on a hundred pools fighting each other and the host for the cores.
+class SharedThreadPool
+{
+public:
+    SharedThreadPool();
+
+    // Threads that can work on one batch: the pool's and the caller's
+    int getConcurrency() const { return pool.getNumThreads() + 1; }
+
+    // Run task(0) .. task(numTasks - 1) on the pool and the calling thread, returning once all
+    // have finished. Workers busy with other instances' batches simply leave this one to the caller.
+    void runParallel(int numTasks, const std::function<void(int)>& task);
+
+private:
+    juce::ThreadPool pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedThreadPool)
+};
@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    StateSpaceCascade.cpp
+
+    Single-channel engine that runs the filter cascade several samples at a time.
+
+  ==============================================================================
+*/
+
+#include "StateSpaceCascade.h"
+
+#if JUCE_USE_SIMD
+
+namespace
+{
+    using Matrix = std::array<std::array<double, 2>, 2>;
+
+    Matrix multiply(const Matrix& a, const Matrix& b) noexcept
+    {
+        Matrix result{};
+
+        for (int row = 0; row < 2; ++row)
+            for (int column = 0; column < 2; ++column)
+                result[row][column] = a[row][0] * b[0][column] + a[row][1] * b[1][column];
+
+        return result;
+    }
+
+    bool operator!=(const BiquadCoefficients& a, const BiquadCoefficients& b) noexcept
+    {
+        return a.b0 != b.b0 || a.b1 != b.b1 || a.b2 != b.b2 || a.a1 != b.a1 || a.a2 != b.a2;
+    }
+}
+
+void StateSpaceCascade::Section::design(const BiquadCoefficients& newCoefficients)
+{
+    coefficients = newCoefficients;
+    isDesigned = true;
+
+    // Transposed direct form II as state space: x' = A x + B u, y = C x + D u with C = (1, 0)
+    const double b0 = coefficients.b0, b1 = coefficients.b1, b2 = coefficients.b2;
+    const double a1 = coefficients.a1, a2 = coefficients.a2;
+
+    const Matrix A{ { { -a1, 1.0 }, { -a2, 0.0 } } };
+    const std::array<double, 2> B{ b1 - a1 * b0, b2 - a2 * b0 };
+    const double D = b0;
+
+    // Powers of A up to the block length
+    std::array<Matrix, blockLength + 1> powers;
+    powers[0] = { { { 1.0, 0.0 }, { 0.0, 1.0 } } };
+
+    for (int k = 1; k <= blockLength; ++k)
+        powers[(size_t) k] = multiply(powers[(size_t) k - 1], A);
+
+    // Impulse response: h[0] = D, h[m] = C A^(m-1) B
+    std::array<double, blockLength> impulse;
+    impulse[0] = D;
+
+    for (int m = 1; m < blockLength; ++m)
+        impulse[(size_t) m] = powers[(size_t) m - 1][0][0] * B[0] + powers[(size_t) m - 1][0][1] * B[1];
+
+    alignas(Register::SIMDRegisterSize) float lanes[blockLength];
+
+    // y[k] gets C A^k of the state
+    for (int k = 0; k < blockLength; ++k)
+        lanes[k] = (float) powers[(size_t) k][0][0];
+    yFromState1 = Register::fromRawArray(lanes);
+
+    for (int k = 0; k < blockLength; ++k)
+        lanes[k] = (float) powers[(size_t) k][0][1];
+    yFromState2 = Register::fromRawArray(lanes);
+
+    // ... and h[k - j] of every input up to and including its own
+    for (int j = 0; j < blockLength; ++j)
+    {
+        for (int k = 0; k < blockLength; ++k)
+            lanes[k] = k >= j ? (float) impulse[(size_t) (k - j)] : 0.f;
+
+        yFromInput[(size_t) j] = Register::fromRawArray(lanes);
+    }
+
+    // Next state: A^N x + sum of A^(N - 1 - j) B u[j]
+    const auto& last = powers[blockLength];
+    nextState1[0] = (float) last[0][0];
+    nextState1[1] = (float) last[0][1];
+    nextState2[0] = (float) last[1][0];
+    nextState2[1] = (float) last[1][1];
+
+    for (int j = 0; j < blockLength; ++j)
+    {
+        const auto& power = powers[(size_t) (blockLength - 1 - j)];
+        nextState1[(size_t) j + 2] = (float) (power[0][0] * B[0] + power[0][1] * B[1]);
+        nextState2[(size_t) j + 2] = (float) (power[1][0] * B[0] + power[1][1] * B[1]);
+    }
+}
+
+void StateSpaceCascade::loadSection(int index, Filter& filter, bool isActive)
+{
+    auto& section = sections[(size_t) index];
+    auto& raw = filter.coefficients->coefficients;
+
+    // Only biquads are supported (every filter is one after prepareCoefficients)
+    section.isActive = isActive && raw.size() == 5;
+
+    if (! section.isActive)
+        return;
+
+    auto* c = raw.getRawDataPointer();
+    BiquadCoefficients coefficients{ c[0], c[1], c[2], c[3], c[4] };
+
+    if (! section.isDesigned || coefficients != section.coefficients)
+        section.design(coefficients);
+}
+
+void StateSpaceCascade::setSections(MonoChain& chain)
+{
+    auto& lowCut = chain.get<ChainPositions::LowCut>();
+    auto& highCut = chain.get<ChainPositions::HighCut>();
+
+    auto lowCutActive = ! chain.isBypassed<ChainPositions::LowCut>();
+    auto highCutActive = ! chain.isBypassed<ChainPositions::HighCut>();
+
+    loadSection(0, lowCut.get<0>(), lowCutActive && ! lowCut.isBypassed<0>());
+    loadSection(1, lowCut.get<1>(), lowCutActive && ! lowCut.isBypassed<1>());
+    loadSection(2, lowCut.get<2>(), lowCutActive && ! lowCut.isBypassed<2>());
+    loadSection(3, lowCut.get<3>(), lowCutActive && ! lowCut.isBypassed<3>());
+    loadSection(4, chain.get<ChainPositions::Peak>(), ! chain.isBypassed<ChainPositions::Peak>());
+    loadSection(5, highCut.get<0>(), highCutActive && ! highCut.isBypassed<0>());
+    loadSection(6, highCut.get<1>(), highCutActive && ! highCut.isBypassed<1>());
+    loadSection(7, highCut.get<2>(), highCutActive && ! highCut.isBypassed<2>());
+    loadSection(8, highCut.get<3>(), highCutActive && ! highCut.isBypassed<3>());
+}
+
+void StateSpaceCascade::reset() noexcept
+{
+    for (auto& section : sections)
+    {
+        section.state1 = 0;
+        section.state2 = 0;
+    }
+}
+
+void StateSpaceCascade::process(float* samples, int numSamples) noexcept
+{
+    // One pass over the (cache-hot) block per section
+    for (auto& section : sections)
+        if (section.isActive)
+            processSection(section, samples, numSamples);
+}
+
+void StateSpaceCascade::processSection(Section& section, float* samples, int numSamples) noexcept
+{
+    auto s1 = section.state1, s2 = section.state2;
+    const auto& n1 = section.nextState1;
+    const auto& n2 = section.nextState2;
+
+    alignas(Register::SIMDRegisterSize) float outputs[blockLength];
+
+    const auto numBlocks = numSamples / blockLength;
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        auto* x = samples + block * blockLength;
+
+        // All N outputs at once, and the only serial dependency: the state N samples on
+        auto y = section.yFromState1 * s1 + section.yFromState2 * s2;
+        auto next1 = n1[0] * s1 + n1[1] * s2;
+        auto next2 = n2[0] * s1 + n2[1] * s2;
+
+        for (int j = 0; j < blockLength; ++j)
+        {
+            const auto u = x[j];
+            y += section.yFromInput[(size_t) j] * u;
+            next1 += n1[(size_t) j + 2] * u;
+            next2 += n2[(size_t) j + 2] * u;
+        }
+
+        s1 = next1;
+        s2 = next2;
+
+        y.copyToRawArray(outputs);
+        std::copy(outputs, outputs + blockLength, x);
+    }
+
+    // Leftover samples one at a time, in the same transposed direct form II state
+    const auto& c = section.coefficients;
+
+    for (int i = numBlocks * blockLength; i < numSamples; ++i)
+    {
+        const auto u = samples[i];
+        const auto y = c.b0 * u + s1;
+        s1 = c.b1 * u - c.a1 * y + s2;
+        s2 = c.b2 * u - c.a2 * y;
+        samples[i] = y;
+    }
+
+    section.state1 = s1;
+    section.state2 = s2;
+}
+
+#endif